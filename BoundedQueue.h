@@ -0,0 +1,64 @@
+/*
+ * Author: Emoy Kim
+ * E-mail: emoy.kim_AT_gmail.com
+ *
+ * This code is a free software; it can be freely used, changed and redistributed.
+ * If you use any version of the code, please reference the code.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+// A queue between pipelined threads. push() waits while the queue is full, and pop() waits while it is empty.
+// After close(), push() fails and pop() fails once the remaining items are drained.
+template<typename T>
+class BoundedQueue
+{
+public:
+   explicit BoundedQueue(size_t capacity) : Capacity( capacity ), Closed( false ) {}
+   ~BoundedQueue() = default;
+
+   bool push(T item)
+   {
+      std::unique_lock<std::mutex> lock( Mutex );
+      NotFull.wait( lock, [this] { return Closed || Items.size() < Capacity; } );
+      if (Closed) return false;
+
+      Items.emplace_back( std::move( item ) );
+      NotEmpty.notify_one();
+      return true;
+   }
+
+   bool pop(T& item)
+   {
+      std::unique_lock<std::mutex> lock( Mutex );
+      NotEmpty.wait( lock, [this] { return Closed || !Items.empty(); } );
+      if (Items.empty()) return false;
+
+      item = std::move( Items.front() );
+      Items.pop_front();
+      NotFull.notify_one();
+      return true;
+   }
+
+   void close()
+   {
+      std::lock_guard<std::mutex> lock( Mutex );
+      Closed = true;
+      NotEmpty.notify_all();
+      NotFull.notify_all();
+   }
+
+private:
+   size_t Capacity;
+   bool Closed;
+   std::deque<T> Items;
+   std::mutex Mutex;
+   std::condition_variable NotEmpty;
+   std::condition_variable NotFull;
+};
\ No newline at end of file
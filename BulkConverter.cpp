@@ -0,0 +1,156 @@
+#include "BulkConverter.h"
+
+BulkConverter::BulkConverter(const LocationDetection& location_detector, int thread_num, size_t chunk_size) :
+   LocationDetector( location_detector ),
+   ThreadNum( thread_num > 0 ? thread_num : std::max( static_cast<int>(std::thread::hardware_concurrency()), 1 ) ),
+   ChunkSize( std::max( chunk_size, static_cast<size_t>(1) ) ), SkippedLines( 0 ), 
+   WritesEventLog( false )
+{
+}
+
+std::vector<BulkConverter::Chunk> BulkConverter::splitAtLineBoundaries(const char* data, size_t size) const
+{
+   std::vector<Chunk> chunks;
+   const char* const end = data + size;
+   const char* begin = data;
+   while (begin < end) {
+      const char* boundary = begin + std::min( ChunkSize, static_cast<size_t>(end - begin) );
+      if (boundary < end) {
+         const auto* newline = static_cast<const char*>(memchr( boundary, '\n', static_cast<size_t>(end - boundary) ));
+         boundary = newline == nullptr ? end : newline + 1;
+      }
+      chunks.emplace_back( begin, boundary );
+      begin = boundary;
+   }
+   return chunks;
+}
+
+void BulkConverter::convertChunk(Chunk& chunk)
+{
+   std::vector<Detection> detections;
+   detections.reserve( static_cast<size_t>(chunk.End - chunk.Begin) / 24 );
+   const char* line = chunk.Begin;
+   while (line < chunk.End) {
+      const auto* newline = static_cast<const char*>(memchr( line, '\n', static_cast<size_t>(chunk.End - line) ));
+      const char* line_end = newline == nullptr ? chunk.End : newline;
+
+      Detection detection;
+      if (parseDetection( detection, line, line_end )) detections.emplace_back( detection );
+      else {
+         const char* ptr = line;
+         while (ptr < line_end && (*ptr == ' ' || *ptr == '\t' || *ptr == '\r')) ++ptr;
+         if (ptr < line_end && *ptr != '#') SkippedLines++;
+      }
+      line = line_end + 1;
+   }
+
+   // visit the detections camera by camera so that the parameters of one camera stay in cache.
+   // the detections of unknown cameras come first with the key 0.
+   const int camera_num = LocationDetector.getCameraNum();
+   const auto key = [camera_num](const Detection& detection)
+   {
+      return 0 <= detection.CameraIndex && detection.CameraIndex < camera_num ? detection.CameraIndex + 1 : 0;
+   };
+   std::vector<size_t> camera_offsets(static_cast<size_t>(camera_num) + 2, 0);
+   for (const auto& detection : detections) camera_offsets[key( detection ) + 1]++;
+   for (size_t i = 1; i < camera_offsets.size(); ++i) camera_offsets[i] += camera_offsets[i - 1];
+   std::vector<size_t> order(detections.size());
+   for (size_t i = 0; i < detections.size(); ++i) order[camera_offsets[key( detections[i] )]++] = i;
+
+   std::vector<LocalizedDetection> localized(detections.size());
+   for (const auto& i : order) LocationDetector.detectLocation( localized[i], detections[i] );
+
+   chunk.RecordNum = localized.size();
+   if (WritesEventLog) {
+      chunk.Localized = std::move( localized );
+      return;
+   }
+
+   char buffer[LocalizedDetectionLineMaxLength];
+   chunk.Output.reserve( localized.size() * 40 );
+   for (const auto& result : localized) chunk.Output.append( buffer, formatLocalizedDetection( buffer, result ) );
+}
+
+bool BulkConverter::convert(const std::string& input_path, const std::string& output_path)
+{
+   using clock = std::chrono::steady_clock;
+
+   MappedFile input;
+   if (!input.open( input_path )) {
+      std::cerr << "Cannot Open " << input_path << "...\n";
+      return false;
+   }
+   std::ofstream output;
+   EventLogWriter output_log;
+   WritesEventLog = isEventLogPath( output_path );
+   if (WritesEventLog) output_log.open( output_path );
+   else output.open( output_path, std::ios::binary );
+   if (WritesEventLog ? !output_log.isOpen() : !output.is_open()) {
+      std::cerr << "Cannot Open " << output_path << "...\n";
+      return false;
+   }
+
+   const auto start = clock::now();
+   SkippedLines = 0;
+   std::vector<Chunk> chunks = splitAtLineBoundaries( input.data(), input.size() );
+
+   // workers can be ahead of the writer by a few chunks, which bounds the memory for the outputs.
+   const size_t window = static_cast<size_t>(ThreadNum) * 2;
+   size_t next = 0, written = 0;
+   std::mutex mutex;
+   std::condition_variable progress;
+   const auto work = [&]()
+   {
+      while (true) {
+         size_t i;
+         {
+            std::unique_lock<std::mutex> lock( mutex );
+            progress.wait( lock, [&] { return next >= chunks.size() || next < written + window; } );
+            if (next >= chunks.size()) return;
+            i = next++;
+         }
+         convertChunk( chunks[i] );
+         {
+            std::lock_guard<std::mutex> lock( mutex );
+            chunks[i].IsDone = true;
+         }
+         progress.notify_all();
+      }
+   };
+   std::vector<std::thread> workers;
+   for (int t = 0; t < ThreadNum; ++t) workers.emplace_back( work );
+
+   size_t record_num = 0;
+   for (auto& chunk : chunks) {
+      {
+         std::unique_lock<std::mutex> lock( mutex );
+         progress.wait( lock, [&chunk] { return chunk.IsDone; } );
+      }
+      if (WritesEventLog) {
+         for (const auto& localized : chunk.Localized) output_log.write( localized );
+      }
+      else output.write( chunk.Output.data(), static_cast<std::streamsize>(chunk.Output.size()) );
+      record_num += chunk.RecordNum;
+      std::string().swap( chunk.Output );
+      std::vector<LocalizedDetection>().swap( chunk.Localized );
+      {
+         std::lock_guard<std::mutex> lock( mutex );
+         written++;
+      }
+      progress.notify_all();
+   }
+   for (auto& worker : workers) worker.join();
+   bool succeeded;
+   if (WritesEventLog) succeeded = output_log.close();
+   else {
+      output.close();
+      succeeded = !output.fail();
+   }
+
+   const double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+   const double megabytes = static_cast<double>(input.size()) / (1024.0 * 1024.0);
+   std::cerr << ">> Converted " << record_num << " records (" << megabytes << " MB) in " << elapsed << " s with "
+      << ThreadNum << " threads: " << static_cast<size_t>(elapsed > 0.0 ? static_cast<double>(record_num) / elapsed : 0.0)
+      << " records/s, " << (elapsed > 0.0 ? megabytes / elapsed : 0.0) << " MB/s, " << SkippedLines << " lines skipped\n";
+   return succeeded;
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+/*
+ * Author: Emoy Kim
+ * E-mail: emoy.kim_AT_gmail.com
+ *
+ * This code is a free software; it can be freely used, changed and redistributed.
+ * If you use any version of the code, please reference the code.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <fstream>
+
+#include "LocationDetection.h"
+#include "MappedFile.h"
+#include "EventLog.h"
+
+// Converts a text dump of detections, which has the same lines as the input of DetectionStream, using all cores.
+// The input is memory-mapped and split into chunks at line boundaries. Each chunk is parsed, localized camera by camera
+// and formatted by a worker thread, and the chunks are written in the input order.
+// The output is an event log instead of text if its path ends with '.evlog'.
+class BulkConverter
+{
+public:
+   explicit BulkConverter(const LocationDetection& location_detector, int thread_num = 0, size_t chunk_size = 16 << 20);
+   ~BulkConverter() = default;
+
+   bool convert(const std::string& input_path, const std::string& output_path);
+
+private:
+   struct Chunk
+   {
+      const char* Begin;
+      const char* End;
+      size_t RecordNum;
+      bool IsDone;
+      std::string Output;
+      std::vector<LocalizedDetection> Localized; // kept only for the event log output
+
+      Chunk(const char* begin, const char* end) : Begin( begin ), End( end ), RecordNum( 0 ), IsDone( false ) {}
+   };
+
+   const LocationDetection& LocationDetector;
+   int ThreadNum;
+   size_t ChunkSize;
+   std::atomic<size_t> SkippedLines;
+   bool WritesEventLog;
+
+   std::vector<Chunk> splitAtLineBoundaries(const char* data, size_t size) const;
+   void convertChunk(Chunk& chunk);
+};
\ No newline at end of file
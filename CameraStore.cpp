@@ -0,0 +1,72 @@
+#include "CameraStore.h"
+
+int CameraStore::find(int camera_index) const
+{
+   const auto it = std::find( Indices.begin(), Indices.end(), camera_index );
+   return it == Indices.end() ? -1 : static_cast<int>(it - Indices.begin());
+}
+
+void CameraStore::getViewingRay(cv::Point3f& origin, cv::Point3f& direction, const cv::Point2f& camera_point, int camera) const
+// the world coordinate is (row(m), depth below the camera(m), column(m)), so it is reordered to the world map.
+{
+   const cv::Point3f ray = ToWorldCoordinates[camera] * cv::Point3f(
+      camera_point.x - HalfWidths[camera],
+      camera_point.y - HalfHeights[camera],
+      FocalLengths[camera]
+   );
+   const float norm = std::sqrt( ray.dot( ray ) );
+   origin = cv::Point3f(Translations[camera].z, Translations[camera].x, CameraHeights[camera] + Altitudes[camera]);
+   direction = cv::Point3f(ray.z / norm, ray.x / norm, -ray.y / norm);
+}
+
+int CameraStore::add(
+   int camera_index,
+   int width,
+   int height,
+   float focal_length,
+   float pan_angle,
+   float tilt_angle,
+   float camera_height,
+   float altitude,
+   const cv::Point3f& translation
+)
+{
+   Indices.emplace_back( camera_index );
+   Widths.emplace_back( width );
+   Heights.emplace_back( height );
+   HalfWidths.emplace_back( static_cast<float>(width) * 0.5f );
+   HalfHeights.emplace_back( static_cast<float>(height) * 0.5f );
+   FocalLengths.emplace_back( focal_length );
+   PanAngles.emplace_back( pan_angle );
+   TiltAngles.emplace_back( tilt_angle );
+   CameraHeights.emplace_back( camera_height );
+   Altitudes.emplace_back( altitude );
+   Translations.emplace_back( translation );
+
+   const cv::Matx33f intrinsic(
+      focal_length, 0.0f, static_cast<float>(width) * 0.5f,
+      0.0f, focal_length, static_cast<float>(height) * 0.5f,
+      0.0f, 0.0f, 1.0f
+   );
+   const float sin_pan = sin( pan_angle );
+   const float cos_pan = cos( pan_angle );
+   const cv::Matx33f panning_to_camera(
+      cos_pan, 0.0f, -sin_pan,
+      0.0f, 1.0f, 0.0f,
+      sin_pan, 0.0f, cos_pan
+   );
+   const float sin_tilt = sin( tilt_angle );
+   const float cos_tilt = cos( tilt_angle );
+   const cv::Matx33f tilting_to_camera(
+      1.0f, 0.0f, 0.0f,
+      0.0f, cos_tilt, -sin_tilt,
+      0.0f, sin_tilt, cos_tilt
+   );
+   SinTilts.emplace_back( sin_tilt );
+   CosTilts.emplace_back( cos_tilt );
+   PanningToCameras.emplace_back( panning_to_camera );
+   TiltingToCameras.emplace_back( tilting_to_camera );
+   ToWorldCoordinates.emplace_back( panning_to_camera.inv() * tilting_to_camera.inv() );
+   ToImages.emplace_back( intrinsic * tilting_to_camera * panning_to_camera );
+   return size() - 1;
+}
\ No newline at end of file
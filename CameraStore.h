@@ -0,0 +1,54 @@
+/*
+ * Author: Emoy Kim
+ * E-mail: emoy.kim_AT_gmail.com
+ *
+ * This code is a free software; it can be freely used, changed and redistributed.
+ * If you use any version of the code, please reference the code.
+ *
+ */
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include <algorithm>
+
+// Parameters of all cameras in structure-of-arrays, and the i-th camera is the i-th element of each array.
+// Only what the projections need is here, so the images rendered for each camera should be kept aside.
+struct CameraStore
+{
+   std::vector<int> Indices;
+   std::vector<int> Widths;
+   std::vector<int> Heights;
+   std::vector<float> HalfWidths;
+   std::vector<float> HalfHeights;
+   std::vector<float> FocalLengths;
+   std::vector<float> PanAngles;
+   std::vector<float> TiltAngles;
+   std::vector<float> SinTilts;
+   std::vector<float> CosTilts;
+   std::vector<float> CameraHeights;
+   std::vector<float> Altitudes;
+   std::vector<cv::Point3f> Translations;
+   std::vector<cv::Matx33f> PanningToCameras;
+   std::vector<cv::Matx33f> TiltingToCameras;
+   std::vector<cv::Matx33f> ToWorldCoordinates; // camera coordinate to world coordinate without translation
+   std::vector<cv::Matx33f> ToImages;           // intrinsic * tilting * panning
+
+   int size() const { return static_cast<int>(Indices.size()); }
+   // the ray through the camera point, whose origin is the camera center and whose direction is a unit vector.
+   // both are in (x(m), y(m), altitude(m)) on the world map, the same as the actual position in meter.
+   void getViewingRay(cv::Point3f& origin, cv::Point3f& direction, const cv::Point2f& camera_point, int camera) const;
+   int find(int camera_index) const;
+   int add(
+      int camera_index,
+      int width,
+      int height,
+      float focal_length,
+      float pan_angle,
+      float tilt_angle,
+      float camera_height,
+      float altitude,
+      const cv::Point3f& translation
+   );
+};
\ No newline at end of file
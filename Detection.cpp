@@ -0,0 +1,48 @@
+#include "Detection.h"
+
+bool parseDetection(Detection& detection, const char* begin, const char* end)
+{
+   double fields[5];
+   int camera_index = 0;
+   int field_num = 0;
+   const char* ptr = begin;
+   while (field_num < 5) {
+      while (ptr < end && (*ptr == ' ' || *ptr == '\t' || *ptr == ',')) ++ptr;
+      if (ptr == end || *ptr == '\r' || *ptr == '\n' || *ptr == '#') break;
+      if (*ptr == '+') ++ptr;
+
+      // the camera index is parsed as an integer, so a fraction or an out-of-range value is rejected.
+      const auto result = field_num == 1 ?
+         std::from_chars( ptr, end, camera_index ) : std::from_chars( ptr, end, fields[field_num] );
+      if (result.ec != std::errc()) return false;
+      ptr = result.ptr;
+      if (ptr < end && *ptr != ' ' && *ptr != '\t' && *ptr != ',' && *ptr != '\r' && *ptr != '\n' && *ptr != '#') {
+         return false;
+      }
+      field_num++;
+   }
+   if (field_num < 4) return false;
+
+   detection.Timestamp = fields[0];
+   detection.CameraIndex = camera_index;
+   detection.CameraPoint.x = static_cast<float>(fields[2]);
+   detection.CameraPoint.y = static_cast<float>(fields[3]);
+   detection.Confidence = field_num == 5 ? static_cast<float>(fields[4]) : 1.0f;
+   return true;
+}
+
+size_t formatLocalizedDetection(char* buffer, const LocalizedDetection& localized)
+{
+   char* const end = buffer + LocalizedDetectionLineMaxLength;
+   char* ptr = std::to_chars( buffer, end, localized.Source.Timestamp, std::chars_format::general, 16 ).ptr;
+   *ptr++ = ',';
+   ptr = std::to_chars( ptr, end, localized.Source.CameraIndex ).ptr;
+   *ptr++ = ',';
+   ptr = std::to_chars( ptr, end, localized.ActualPositionInMeter.x, std::chars_format::fixed, 3 ).ptr;
+   *ptr++ = ',';
+   ptr = std::to_chars( ptr, end, localized.ActualPositionInMeter.y, std::chars_format::fixed, 3 ).ptr;
+   *ptr++ = ',';
+   *ptr++ = localized.IsValid ? '1' : '0';
+   *ptr++ = '\n';
+   return static_cast<size_t>(ptr - buffer);
+}
\ No newline at end of file
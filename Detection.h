@@ -0,0 +1,50 @@
+/*
+ * Author: Emoy Kim
+ * E-mail: emoy.kim_AT_gmail.com
+ *
+ * This code is a free software; it can be freely used, changed and redistributed.
+ * If you use any version of the code, please reference the code.
+ *
+ */
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <charconv>
+
+// A point detected on a camera. CameraIndex is the same as the camera_index of LocationDetection::detectLocation().
+struct Detection
+{
+   double Timestamp;
+   int CameraIndex;
+   cv::Point2f CameraPoint;
+   float Confidence;
+
+   Detection() : Timestamp( 0.0 ), CameraIndex( -1 ), Confidence( 1.0f ) {}
+   Detection(double timestamp, int camera_index, const cv::Point2f& camera_point, float confidence = 1.0f) :
+      Timestamp( timestamp ), CameraIndex( camera_index ), CameraPoint( camera_point ), Confidence( confidence ) {}
+};
+
+// The location of a detection on the world map, which is (-1, -1) if the camera cannot see the floor there.
+// ZoneIndex is the index of the zone on top at the location, or -1 if no zone covers it.
+// PositionCovariance is (variance of x, covariance of x and y, variance of y) in square meters
+// for one pixel of noise on the camera, which is 0 if it is not valid.
+struct LocalizedDetection
+{
+   Detection Source;
+   cv::Point2f ActualPositionInMeter;
+   cv::Vec3f PositionCovariance;
+   int ZoneIndex;
+   bool IsValid;
+
+   LocalizedDetection() : ActualPositionInMeter( -1.0f, -1.0f ), PositionCovariance( 0.0f, 0.0f, 0.0f ), ZoneIndex( -1 ), IsValid( false ) {}
+};
+
+// The longest line which formatLocalizedDetection() writes.
+constexpr size_t LocalizedDetectionLineMaxLength = 192;
+
+// parses 'timestamp, camera index, x, y[, confidence]' in [begin, end), whose fields are separated by commas or spaces.
+bool parseDetection(Detection& detection, const char* begin, const char* end);
+
+// writes 'timestamp,camera index,x,y,valid' and a newline to the buffer, and returns the number of written characters.
+size_t formatLocalizedDetection(char* buffer, const LocalizedDetection& localized);
\ No newline at end of file
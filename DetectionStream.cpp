@@ -0,0 +1,147 @@
+#include "DetectionStream.h"
+
+DetectionStream::DetectionStream(const LocationDetection& location_detector, size_t batch_size, size_t queue_capacity) :
+   LocationDetector( location_detector ), BatchSize( std::max( batch_size, static_cast<size_t>(1) ) ),
+   QueueCapacity( std::max( queue_capacity, static_cast<size_t>(1) ) ), SkippedLines( 0 )
+{
+}
+
+void DetectionStream::parse(std::istream& input, BoundedQueue<DetectionBatch>& parsed)
+{
+   std::string line;
+   DetectionBatch batch;
+   batch.reserve( BatchSize );
+   while (std::getline( input, line )) {
+      Detection detection;
+      if (!parseDetection( detection, line.data(), line.data() + line.size() )) {
+         const size_t first = line.find_first_not_of( " \t\r" );
+         if (first != std::string::npos && line[first] != '#') SkippedLines++;
+         continue;
+      }
+
+      batch.emplace_back( detection );
+      if (batch.size() == BatchSize) {
+         if (!parsed.push( std::move( batch ) )) break;
+         batch = DetectionBatch();
+         batch.reserve( BatchSize );
+      }
+   }
+   if (!batch.empty()) parsed.push( std::move( batch ) );
+   parsed.close();
+}
+
+void DetectionStream::read(const EventLogReader& input, BoundedQueue<DetectionBatch>& parsed) const
+{
+   for (size_t c = 0; c < input.getChunkNum(); ++c) {
+      const EventChunk chunk = input.getChunk( c );
+      for (size_t offset = 0; offset < chunk.Size; offset += BatchSize) {
+         DetectionBatch batch(std::min( BatchSize, chunk.Size - offset ));
+         for (size_t i = 0; i < batch.size(); ++i) batch[i] = chunk.getDetection( offset + i );
+         if (!parsed.push( std::move( batch ) )) {
+            parsed.close();
+            return;
+         }
+      }
+   }
+   parsed.close();
+}
+
+void DetectionStream::convert(BoundedQueue<DetectionBatch>& parsed, BoundedQueue<LocalizedBatch>& converted) const
+{
+   DetectionBatch batch;
+   while (parsed.pop( batch )) {
+      LocalizedBatch localized;
+      LocationDetector.detectLocations( localized, batch );
+      if (!converted.push( std::move( localized ) )) break;
+   }
+   converted.close();
+}
+
+void DetectionStream::write(std::ostream* text_output, EventLogWriter* log_output, BoundedQueue<LocalizedBatch>& converted) const
+{
+   using clock = std::chrono::steady_clock;
+
+   size_t total = 0, since_report = 0;
+   const auto start = clock::now();
+   auto last_report = start;
+   LocalizedBatch batch;
+   char buffer[LocalizedDetectionLineMaxLength];
+   while (converted.pop( batch )) {
+      if (log_output != nullptr) {
+         for (const auto& localized : batch) log_output->write( localized );
+      }
+      else {
+         for (const auto& localized : batch) {
+            text_output->write( buffer, static_cast<std::streamsize>(formatLocalizedDetection( buffer, localized )) );
+         }
+      }
+      total += batch.size();
+      since_report += batch.size();
+
+      const auto now = clock::now();
+      const double seconds = std::chrono::duration<double>(now - last_report).count();
+      if (seconds >= 1.0) {
+         std::cerr << ">> " << total << " records, " << static_cast<size_t>(static_cast<double>(since_report) / seconds) << " records/s\n";
+         since_report = 0;
+         last_report = now;
+      }
+   }
+   if (log_output != nullptr) log_output->close();
+   else text_output->flush();
+
+   const double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+   std::cerr << ">> Localized " << total << " records in " << elapsed << " s ("
+      << static_cast<size_t>(elapsed > 0.0 ? static_cast<double>(total) / elapsed : 0.0) << " records/s), "
+      << SkippedLines << " lines skipped\n";
+}
+
+bool DetectionStream::run(const std::string& input_path, const std::string& output_path)
+{
+   std::ifstream input_file;
+   EventLogReader input_log;
+   const bool reads_log = isEventLogPath( input_path );
+   if (reads_log) {
+      if (!input_log.open( input_path )) {
+         std::cerr << "Cannot Open " << input_path << "...\n";
+         return false;
+      }
+   }
+   else if (input_path != "-") {
+      input_file.open( input_path );
+      if (!input_file.is_open()) {
+         std::cerr << "Cannot Open " << input_path << "...\n";
+         return false;
+      }
+   }
+
+   std::ofstream output_file;
+   EventLogWriter output_log;
+   const bool writes_log = isEventLogPath( output_path );
+   if (writes_log) {
+      if (!output_log.open( output_path )) {
+         std::cerr << "Cannot Open " << output_path << "...\n";
+         return false;
+      }
+   }
+   else if (output_path != "-") {
+      output_file.open( output_path, std::ios::binary );
+      if (!output_file.is_open()) {
+         std::cerr << "Cannot Open " << output_path << "...\n";
+         return false;
+      }
+   }
+   std::istream& input = input_path == "-" ? std::cin : input_file;
+   std::ostream& output = output_path == "-" ? std::cout : output_file;
+
+   SkippedLines = 0;
+   BoundedQueue<DetectionBatch> parsed(QueueCapacity);
+   BoundedQueue<LocalizedBatch> converted(QueueCapacity);
+   std::thread parser = reads_log ?
+      std::thread( &DetectionStream::read, this, std::cref( input_log ), std::ref( parsed ) ) :
+      std::thread( &DetectionStream::parse, this, std::ref( input ), std::ref( parsed ) );
+   std::thread converter( &DetectionStream::convert, this, std::ref( parsed ), std::ref( converted ) );
+   write( &output, writes_log ? &output_log : nullptr, converted );
+   converter.join();
+   parser.join();
+   return true;
+}
\ No newline at end of file
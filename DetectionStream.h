@@ -0,0 +1,48 @@
+/*
+ * Author: Emoy Kim
+ * E-mail: emoy.kim_AT_gmail.com
+ *
+ * This code is a free software; it can be freely used, changed and redistributed.
+ * If you use any version of the code, please reference the code.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <fstream>
+
+#include "LocationDetection.h"
+#include "BoundedQueue.h"
+#include "EventLog.h"
+
+// Headless mode which localizes detection records streamed from a file, a named pipe or stdin.
+// Each input line is 'timestamp, camera index, x, y[, confidence]' separated by commas or spaces,
+// and each output line is 'timestamp, camera index, x(m), y(m), valid'.
+// The input or the output is an event log instead of text if its path ends with '.evlog'.
+// Parsing, conversion and output run in their own threads connected by bounded queues of batches.
+class DetectionStream
+{
+public:
+   explicit DetectionStream(const LocationDetection& location_detector, size_t batch_size = 4096, size_t queue_capacity = 16);
+   ~DetectionStream() = default;
+
+   // "-" is stdin for input_path and stdout for output_path.
+   bool run(const std::string& input_path, const std::string& output_path);
+
+private:
+   using DetectionBatch = std::vector<Detection>;
+   using LocalizedBatch = std::vector<LocalizedDetection>;
+
+   const LocationDetection& LocationDetector;
+   size_t BatchSize;
+   size_t QueueCapacity;
+   std::atomic<size_t> SkippedLines;
+
+   void parse(std::istream& input, BoundedQueue<DetectionBatch>& parsed);
+   void read(const EventLogReader& input, BoundedQueue<DetectionBatch>& parsed) const;
+   void convert(BoundedQueue<DetectionBatch>& parsed, BoundedQueue<LocalizedBatch>& converted) const;
+   void write(std::ostream* text_output, EventLogWriter* log_output, BoundedQueue<LocalizedBatch>& converted) const;
+};
\ No newline at end of file
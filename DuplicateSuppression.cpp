@@ -0,0 +1,97 @@
+#include "DuplicateSuppression.h"
+
+DuplicateSuppression::DuplicateSuppression(const LocationDetection& location_detector, float radius_in_meter, double time_window) :
+   LocationDetector( location_detector ), Radius( std::max( radius_in_meter, MinRadius ) ), TimeWindow( time_window ),
+   LatestTimestamp( -std::numeric_limits<double>::infinity() ), SuppressedNum( 0 )
+{
+}
+
+void DuplicateSuppression::insert(Candidate&& candidate)
+{
+   CandidateGrid.insert( static_cast<int>(Candidates.size()), candidate.Localized.ActualPositionInMeter );
+   Candidates.emplace_back( std::move( candidate ) );
+}
+
+void DuplicateSuppression::rebuildGrid(size_t expected_num)
+{
+   CandidateGrid.reset( Radius, expected_num );
+   for (size_t i = 0; i < Candidates.size(); ++i) {
+      CandidateGrid.insert( static_cast<int>(i), Candidates[i].Localized.ActualPositionInMeter );
+   }
+}
+
+int DuplicateSuppression::findNearest(const LocalizedDetection& localized) const
+{
+   const cv::Point2f& position = localized.ActualPositionInMeter;
+   int nearest = -1;
+   float nearest_squared_distance = Radius * Radius;
+   CandidateGrid.forEachNeighbor(
+      position,
+      [&](int i)
+      {
+         const Candidate& candidate = Candidates[i];
+         if (candidate.IsMerged || localized.Source.Timestamp - candidate.Localized.Source.Timestamp > TimeWindow ||
+             std::find(
+                candidate.CameraIndices.begin(), candidate.CameraIndices.end(), localized.Source.CameraIndex
+             ) != candidate.CameraIndices.end()) return;
+
+         const cv::Point2f difference = candidate.Localized.ActualPositionInMeter - position;
+         const float squared_distance = difference.dot( difference );
+         if (squared_distance <= nearest_squared_distance) {
+            nearest = i;
+            nearest_squared_distance = squared_distance;
+         }
+      }
+   );
+   return nearest;
+}
+
+void DuplicateSuppression::suppress(std::vector<LocalizedDetection>& unique, const std::vector<LocalizedDetection>& detections)
+{
+   rebuildGrid( Candidates.size() + detections.size() );
+   for (const auto& localized : detections) {
+      if (!localized.IsValid) continue;
+
+      LatestTimestamp = std::max( LatestTimestamp, localized.Source.Timestamp );
+      Candidate candidate{
+         localized,
+         LocationDetector.getMeterPerPixel( localized ),
+         { localized.Source.CameraIndex },
+         false
+      };
+      const int nearest = findNearest( localized );
+      if (nearest < 0) insert( std::move( candidate ) );
+      else {
+         SuppressedNum++;
+         Candidates[nearest].CameraIndices.emplace_back( localized.Source.CameraIndex );
+         if (candidate.MeterPerPixel < Candidates[nearest].MeterPerPixel) {
+            candidate.CameraIndices = std::move( Candidates[nearest].CameraIndices );
+            Candidates[nearest].IsMerged = true;
+            insert( std::move( candidate ) );
+         }
+      }
+   }
+
+   // candidates are kept in insertion order, so the released ones keep the timestamp order.
+   size_t remaining = 0;
+   for (size_t i = 0; i < Candidates.size(); ++i) {
+      Candidate& candidate = Candidates[i];
+      if (candidate.IsMerged) continue;
+      if (LatestTimestamp - candidate.Localized.Source.Timestamp > TimeWindow) {
+         unique.emplace_back( candidate.Localized );
+      }
+      else {
+         if (remaining != i) Candidates[remaining] = std::move( candidate );
+         remaining++;
+      }
+   }
+   Candidates.resize( remaining );
+}
+
+void DuplicateSuppression::flush(std::vector<LocalizedDetection>& unique)
+{
+   for (const auto& candidate : Candidates) {
+      if (!candidate.IsMerged) unique.emplace_back( candidate.Localized );
+   }
+   Candidates.clear();
+}
\ No newline at end of file
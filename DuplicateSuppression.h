@@ -0,0 +1,56 @@
+/*
+ * Author: Emoy Kim
+ * E-mail: emoy.kim_AT_gmail.com
+ *
+ * This code is a free software; it can be freely used, changed and redistributed.
+ * If you use any version of the code, please reference the code.
+ *
+ */
+
+#pragma once
+
+#include "LocationDetection.h"
+#include "SpatialHashGrid.h"
+
+// Merges the localized detections of one target which overlapping cameras see at the same time.
+// Detections within the radius and the time window from different cameras are regarded as the same target,
+// and the one from the camera with the finest resolution there, i.e. the smallest meter per pixel, is kept.
+// Candidates are found in a spatial hash grid whose cell is as large as the radius, so each detection is compared
+// only with the ones in the nine cells around it.
+class DuplicateSuppression
+{
+public:
+   DuplicateSuppression(const LocationDetection& location_detector, float radius_in_meter = 0.5f, double time_window = 0.1);
+   ~DuplicateSuppression() = default;
+   // the radius is at least MinRadius, since the grid cell is as large as the radius.
+
+   // the detections should be in timestamp order as FusionIngest passes them, and invalid ones are dropped.
+   // a kept detection is appended to unique after no later detection can be merged with it, i.e. time_window later.
+   void suppress(std::vector<LocalizedDetection>& unique, const std::vector<LocalizedDetection>& detections);
+   void flush(std::vector<LocalizedDetection>& unique);
+
+   uint64_t getSuppressedNum() const { return SuppressedNum; }
+
+private:
+   static constexpr float MinRadius = 0.01f;
+
+   struct Candidate
+   {
+      LocalizedDetection Localized;
+      float MeterPerPixel;
+      std::vector<int> CameraIndices; // cameras which have seen this target in the time window, which are only a few
+      bool IsMerged;
+   };
+
+   const LocationDetection& LocationDetector;
+   float Radius;
+   double TimeWindow;
+   double LatestTimestamp;
+   uint64_t SuppressedNum;
+   std::vector<Candidate> Candidates;
+   SpatialHashGrid CandidateGrid;
+
+   void insert(Candidate&& candidate);
+   void rebuildGrid(size_t expected_num);
+   int findNearest(const LocalizedDetection& localized) const;
+};
\ No newline at end of file
@@ -0,0 +1,216 @@
+#include "DwellStatistics.h"
+
+TDigest::TDigest(double compression) :
+   Compression( compression ), TotalWeight( 0.0 ), BufferedWeight( 0.0 ),
+   Min( std::numeric_limits<double>::infinity() ), Max( -std::numeric_limits<double>::infinity() )
+{
+}
+
+void TDigest::add(double value, double weight)
+{
+   if (std::isnan( value ) || weight <= 0.0) return;
+
+   Buffer.push_back( { value, weight } );
+   BufferedWeight += weight;
+   Min = std::min( Min, value );
+   Max = std::max( Max, value );
+   if (Buffer.size() >= static_cast<size_t>(Compression) * 5) compress();
+}
+
+void TDigest::merge(const TDigest& other)
+{
+   compress();
+   other.compress();
+   for (const auto& centroid : other.Centroids) Buffer.emplace_back( centroid );
+   BufferedWeight += other.TotalWeight;
+   Min = std::min( Min, other.Min );
+   Max = std::max( Max, other.Max );
+   compress();
+}
+
+void TDigest::compress() const
+// a centroid grows while its quantile range stays within one unit of the scale k(q) = compression / 2pi * asin(2q - 1).
+{
+   if (Buffer.empty()) return;
+
+   Buffer.insert( Buffer.end(), Centroids.begin(), Centroids.end() );
+   std::sort( Buffer.begin(), Buffer.end(), [](const Centroid& a, const Centroid& b) { return a.Mean < b.Mean; } );
+   TotalWeight += BufferedWeight;
+   BufferedWeight = 0.0;
+
+   const double pi = 3.14159265358979323846;
+   const auto getScale = [this, pi](double q) { return Compression / (2.0 * pi) * asin( 2.0 * q - 1.0 ); };
+   const auto getQuantileOfScale = [this, pi](double k)
+   {
+      return k >= Compression * 0.25 ? 1.0 : (sin( 2.0 * pi * k / Compression ) + 1.0) * 0.5;
+   };
+
+   Centroids.clear();
+   Centroid current = Buffer[0];
+   double weight_so_far = 0.0;
+   double weight_limit = TotalWeight * getQuantileOfScale( getScale( 0.0 ) + 1.0 );
+   for (size_t i = 1; i < Buffer.size(); ++i) {
+      const Centroid& next = Buffer[i];
+      if (weight_so_far + current.Weight + next.Weight <= weight_limit) {
+         current.Mean += (next.Mean - current.Mean) * next.Weight / (current.Weight + next.Weight);
+         current.Weight += next.Weight;
+         continue;
+      }
+      weight_so_far += current.Weight;
+      weight_limit = TotalWeight * getQuantileOfScale( getScale( weight_so_far / TotalWeight ) + 1.0 );
+      Centroids.emplace_back( current );
+      current = next;
+   }
+   Centroids.emplace_back( current );
+   Buffer.clear();
+}
+
+double TDigest::getQuantile(double quantile) const
+// interpolates between the centers of the centroids, and between the extremes and the outermost centers.
+{
+   compress();
+   if (Centroids.empty()) return std::numeric_limits<double>::quiet_NaN();
+   if (Centroids.size() == 1) return Centroids[0].Mean;
+
+   const double target = std::min( std::max( quantile, 0.0 ), 1.0 ) * TotalWeight;
+   const double first_center = Centroids.front().Weight * 0.5;
+   if (target < first_center) return Min + (Centroids.front().Mean - Min) * target / first_center;
+
+   double center = first_center;
+   for (size_t i = 1; i < Centroids.size(); ++i) {
+      const double next_center = center + (Centroids[i - 1].Weight + Centroids[i].Weight) * 0.5;
+      if (target <= next_center) {
+         const double t = (target - center) / (next_center - center);
+         return Centroids[i - 1].Mean + (Centroids[i].Mean - Centroids[i - 1].Mean) * t;
+      }
+      center = next_center;
+   }
+   const double last_half = Centroids.back().Weight * 0.5;
+   return Centroids.back().Mean + (Max - Centroids.back().Mean) * std::min( (target - center) / last_half, 1.0 );
+}
+
+bool TDigest::write(std::ostream& stream) const
+{
+   compress();
+   const auto centroid_num = static_cast<uint64_t>(Centroids.size());
+   stream.write( reinterpret_cast<const char*>(&Compression), sizeof( Compression ) );
+   stream.write( reinterpret_cast<const char*>(&Min), sizeof( Min ) );
+   stream.write( reinterpret_cast<const char*>(&Max), sizeof( Max ) );
+   stream.write( reinterpret_cast<const char*>(&centroid_num), sizeof( centroid_num ) );
+   stream.write( reinterpret_cast<const char*>(Centroids.data()), static_cast<std::streamsize>(Centroids.size() * sizeof( Centroid )) );
+   return stream.good();
+}
+
+bool TDigest::read(std::istream& stream)
+// read into locals first, so the digest is left as it was if the stream is broken.
+{
+   double compression = 0.0, min = 0.0, max = 0.0;
+   uint64_t centroid_num = 0;
+   stream.read( reinterpret_cast<char*>(&compression), sizeof( compression ) );
+   stream.read( reinterpret_cast<char*>(&min), sizeof( min ) );
+   stream.read( reinterpret_cast<char*>(&max), sizeof( max ) );
+   stream.read( reinterpret_cast<char*>(&centroid_num), sizeof( centroid_num ) );
+   if (!stream.good() || !(compression > 0.0) || centroid_num > (1u << 20)) return false;
+
+   std::vector<Centroid> centroids(static_cast<size_t>(centroid_num));
+   stream.read( reinterpret_cast<char*>(centroids.data()), static_cast<std::streamsize>(centroids.size() * sizeof( Centroid )) );
+   if (!stream.good()) return false;
+
+   Compression = compression;
+   Min = min;
+   Max = max;
+   Centroids = std::move( centroids );
+   Buffer.clear();
+   BufferedWeight = 0.0;
+   TotalWeight = 0.0;
+   for (const auto& centroid : Centroids) TotalWeight += centroid.Weight;
+   return true;
+}
+
+DwellStatistics::DwellStatistics(int zone_num, double compression) : Digests( zone_num, TDigest( compression ) )
+{
+}
+
+void DwellStatistics::add(const GeofenceEvent& event)
+{
+   if (event.Type != GeofenceEventType::Exit || event.ZoneIndex < 0 || event.ZoneIndex >= getZoneNum()) return;
+   Digests[event.ZoneIndex].add( event.DwellTime );
+}
+
+void DwellStatistics::merge(const DwellStatistics& other)
+{
+   const int zone_num = std::min( getZoneNum(), other.getZoneNum() );
+   for (int i = 0; i < zone_num; ++i) Digests[i].merge( other.Digests[i] );
+}
+
+bool DwellStatistics::save(const std::string& path) const
+{
+   std::ofstream file(path, std::ios::binary | std::ios::trunc);
+   if (!file.is_open()) {
+      std::cerr << "Cannot Open the Dwell Statistics: " << path << "\n";
+      return false;
+   }
+   const auto zone_num = static_cast<uint32_t>(Digests.size());
+   file.write( reinterpret_cast<const char*>(&zone_num), sizeof( zone_num ) );
+   for (const auto& digest : Digests) {
+      if (!digest.write( file )) return false;
+   }
+   return file.good();
+}
+
+bool DwellStatistics::load(const std::string& path)
+{
+   std::ifstream file(path, std::ios::binary);
+   if (!file.is_open()) {
+      std::cerr << "Cannot Open the Dwell Statistics: " << path << "\n";
+      return false;
+   }
+   uint32_t zone_num = 0;
+   file.read( reinterpret_cast<char*>(&zone_num), sizeof( zone_num ) );
+   if (!file.good() || zone_num > MaxZoneNum) return false;
+
+   std::vector<TDigest> digests;
+   for (uint32_t i = 0; i < zone_num; ++i) {
+      TDigest digest;
+      if (!digest.read( file )) return false;
+      digests.emplace_back( std::move( digest ) );
+   }
+   Digests = std::move( digests );
+   return true;
+}
+
+bool checkTDigest(int sample_num)
+{
+   constexpr double max_rank_error = 0.001;
+   std::mt19937 generator(0);
+   std::lognormal_distribution<double> dwell_time(3.0, 1.0);
+   std::vector<double> samples(std::max( sample_num, 1 ));
+   std::vector<TDigest> digests(4);
+   for (size_t i = 0; i < samples.size(); ++i) {
+      samples[i] = dwell_time( generator );
+      digests[i % digests.size()].add( samples[i] );
+   }
+   for (size_t i = 1; i < digests.size(); ++i) digests[0].merge( digests[i] );
+
+   std::stringstream stream;
+   TDigest restored;
+   if (!digests[0].write( stream ) || !restored.read( stream )) {
+      std::cerr << "Cannot Round-trip the Digest\n";
+      return false;
+   }
+
+   // the error is measured in rank, i.e. how far the quantile of the estimated value is from the asked one,
+   // since a few centroids cover the sparse tail and the value there can move more than the rank does.
+   std::sort( samples.begin(), samples.end() );
+   bool is_accurate = true;
+   for (const double quantile : { 0.5, 0.9, 0.99 }) {
+      const double estimated = restored.getQuantile( quantile );
+      const auto below = std::lower_bound( samples.begin(), samples.end(), estimated ) - samples.begin();
+      const double rank_error = std::abs( static_cast<double>(below) / static_cast<double>(samples.size()) - quantile );
+      const double exact = samples[static_cast<size_t>(quantile * static_cast<double>(samples.size() - 1))];
+      std::cout << "p" << quantile * 100.0 << ": " << estimated << " (exact " << exact << ", rank error "
+         << rank_error * 100.0 << "%)\n";
+      if (!(rank_error <= max_rank_error)) is_accurate = false;
+   }
+   return is_accurate;
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+/*
+ * Author: Emoy Kim
+ * E-mail: emoy.kim_AT_gmail.com
+ *
+ * This code is a free software; it can be freely used, changed and redistributed.
+ * If you use any version of the code, please reference the code.
+ *
+ */
+
+#pragma once
+
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <limits>
+
+#include "GeofenceEngine.h"
+
+// Merging t-digest, which keeps a bounded number of centroids whose sizes are small near both tails,
+// so extreme quantiles stay accurate while the memory does not grow with the number of values.
+// Values are buffered and merged into the centroids when the buffer is full or a quantile is asked.
+class TDigest
+{
+public:
+   explicit TDigest(double compression = 100.0);
+   ~TDigest() = default;
+
+   void add(double value, double weight = 1.0);
+   void merge(const TDigest& other);
+   double getQuantile(double quantile) const; // NaN if empty
+   double getTotalWeight() const { return TotalWeight + BufferedWeight; }
+
+   bool write(std::ostream& stream) const;
+   bool read(std::istream& stream);
+
+private:
+   struct Centroid
+   {
+      double Mean;
+      double Weight;
+   };
+
+   double Compression;
+   mutable double TotalWeight;
+   mutable double BufferedWeight;
+   double Min;
+   double Max;
+   mutable std::vector<Centroid> Centroids;
+   mutable std::vector<Centroid> Buffer;
+
+   void compress() const;
+};
+
+// Distributions of how long tracks stay in each zone, fed by the Exit events of GeofenceEngine.
+// It is not thread-safe, so each thread should have its own one and merge them, e.g. per day into a longer period.
+class DwellStatistics
+{
+public:
+   explicit DwellStatistics(int zone_num, double compression = 100.0);
+   ~DwellStatistics() = default;
+
+   void add(const GeofenceEvent& event);
+   void merge(const DwellStatistics& other);
+
+   // the dwell time in seconds at the quantile in [0, 1], e.g. 0.5, 0.9, or 0.99.
+   // NaN if the zone index is not valid.
+   double getQuantile(int zone_index, double quantile) const
+   {
+      return isValidZone( zone_index ) ? Digests[zone_index].getQuantile( quantile ) : std::numeric_limits<double>::quiet_NaN();
+   }
+   double getExitNum(int zone_index) const { return isValidZone( zone_index ) ? Digests[zone_index].getTotalWeight() : 0.0; }
+   int getZoneNum() const { return static_cast<int>(Digests.size()); }
+
+   bool save(const std::string& path) const;
+   bool load(const std::string& path);
+
+private:
+   static constexpr uint32_t MaxZoneNum = 1u << 16; // of a file to load
+
+   std::vector<TDigest> Digests;
+
+   bool isValidZone(int zone_index) const { return 0 <= zone_index && zone_index < getZoneNum(); }
+};
+
+// feeds log-normal dwell times to four digests, merges them and round-trips the merged one through a stream.
+// the estimated p50, p90 and p99 should be within 0.1% in rank of the exact quantiles of the samples.
+bool checkTDigest(int sample_num);
\ No newline at end of file
@@ -0,0 +1,179 @@
+#include "EventLog.h"
+
+namespace
+{
+   constexpr char EventLogMagic[8] = { 'L', 'D', 'E', 'V', 'L', 'O', 'G', '\0' };
+   constexpr uint32_t EventLogVersion = 1;
+
+   size_t alignTo8(size_t size) { return (size + 7) & ~static_cast<size_t>(7); }
+
+   constexpr size_t EventRecordSize = sizeof( double ) + 7 * sizeof( int32_t ) + sizeof( uint8_t );
+
+   size_t getChunkSize(size_t record_num) { return alignTo8( record_num * EventRecordSize ); }
+
+   template<typename T>
+   void writeColumn(std::ofstream& file, const std::vector<T>& column)
+   {
+      file.write( reinterpret_cast<const char*>(column.data()), static_cast<std::streamsize>(column.size() * sizeof( T )) );
+   }
+}
+
+bool isEventLogPath(const std::string& path)
+{
+   const std::string extension(".evlog");
+   return path.size() > extension.size() && path.compare( path.size() - extension.size(), extension.size(), extension ) == 0;
+}
+
+EventLogWriter::EventLogWriter(size_t chunk_capacity) :
+   ChunkCapacity( static_cast<uint32_t>(std::max( chunk_capacity, static_cast<size_t>(1) )) ), RecordNum( 0 )
+{
+}
+
+bool EventLogWriter::open(const std::string& path)
+{
+   close();
+   File.open( path, std::ios::binary | std::ios::trunc );
+   if (!File.is_open()) return false;
+
+   RecordNum = 0;
+   ChunkIndex.clear();
+   const EventLogHeader header{};
+   File.write( reinterpret_cast<const char*>(&header), sizeof( header ) );
+   File.write( "\0\0\0\0\0\0\0\0", static_cast<std::streamsize>(alignTo8( sizeof( header ) ) - sizeof( header )) );
+   return File.good();
+}
+
+void EventLogWriter::write(const Detection& detection)
+{
+   LocalizedDetection localized;
+   localized.Source = detection;
+   write( localized );
+}
+
+void EventLogWriter::write(const LocalizedDetection& localized)
+{
+   Timestamps.emplace_back( localized.Source.Timestamp );
+   CameraIndices.emplace_back( localized.Source.CameraIndex );
+   CameraX.emplace_back( localized.Source.CameraPoint.x );
+   CameraY.emplace_back( localized.Source.CameraPoint.y );
+   Confidences.emplace_back( localized.Source.Confidence );
+   WorldX.emplace_back( localized.ActualPositionInMeter.x );
+   WorldY.emplace_back( localized.ActualPositionInMeter.y );
+   ZoneIndices.emplace_back( localized.ZoneIndex );
+   Validities.emplace_back( localized.IsValid ? 1 : 0 );
+   if (Timestamps.size() == ChunkCapacity) flushChunk();
+}
+
+void EventLogWriter::flushChunk()
+{
+   if (Timestamps.empty()) return;
+
+   EventLogChunkInfo info{};
+   info.Offset = static_cast<uint64_t>(File.tellp());
+   info.RecordNum = Timestamps.size();
+   const auto range = std::minmax_element( Timestamps.begin(), Timestamps.end() );
+   info.MinTimestamp = *range.first;
+   info.MaxTimestamp = *range.second;
+   ChunkIndex.emplace_back( info );
+
+   writeColumn( File, Timestamps );
+   writeColumn( File, CameraIndices );
+   writeColumn( File, CameraX );
+   writeColumn( File, CameraY );
+   writeColumn( File, Confidences );
+   writeColumn( File, WorldX );
+   writeColumn( File, WorldY );
+   writeColumn( File, ZoneIndices );
+   writeColumn( File, Validities );
+   const size_t written = static_cast<size_t>(File.tellp()) - static_cast<size_t>(info.Offset);
+   File.write( "\0\0\0\0\0\0\0\0", static_cast<std::streamsize>(getChunkSize( info.RecordNum ) - written) );
+   RecordNum += info.RecordNum;
+
+   Timestamps.clear();
+   CameraIndices.clear();
+   CameraX.clear();
+   CameraY.clear();
+   Confidences.clear();
+   WorldX.clear();
+   WorldY.clear();
+   ZoneIndices.clear();
+   Validities.clear();
+}
+
+bool EventLogWriter::close()
+{
+   if (!File.is_open()) return false;
+
+   flushChunk();
+   EventLogHeader header{};
+   std::copy( EventLogMagic, EventLogMagic + sizeof( header.Magic ), header.Magic );
+   header.Version = EventLogVersion;
+   header.ChunkCapacity = ChunkCapacity;
+   header.RecordNum = RecordNum;
+   header.ChunkNum = ChunkIndex.size();
+   header.IndexOffset = static_cast<uint64_t>(File.tellp());
+   writeColumn( File, ChunkIndex );
+   File.seekp( 0 );
+   File.write( reinterpret_cast<const char*>(&header), sizeof( header ) );
+
+   const bool succeeded = File.good();
+   File.close();
+   return succeeded;
+}
+
+bool EventLogReader::open(const std::string& path)
+{
+   ChunkIndex = ColumnSpan<EventLogChunkInfo>();
+   if (!File.open( path ) || File.size() < sizeof( EventLogHeader )) return false;
+
+   std::copy( File.data(), File.data() + sizeof( Header ), reinterpret_cast<char*>(&Header) );
+   // the sizes are compared by division, so a corrupt header cannot overflow them.
+   if (!std::equal( EventLogMagic, EventLogMagic + sizeof( Header.Magic ), Header.Magic ) || Header.Version != EventLogVersion ||
+       Header.IndexOffset % 8 != 0 || Header.IndexOffset > File.size() ||
+       Header.ChunkNum > (File.size() - Header.IndexOffset) / sizeof( EventLogChunkInfo )) {
+      File.close();
+      return false;
+   }
+
+   ChunkIndex = ColumnSpan<EventLogChunkInfo>(
+      reinterpret_cast<const EventLogChunkInfo*>(File.data() + Header.IndexOffset), static_cast<size_t>(Header.ChunkNum)
+   );
+   for (const auto& info : ChunkIndex) {
+      if (info.Offset % 8 != 0 || info.Offset > Header.IndexOffset ||
+          info.RecordNum > (Header.IndexOffset - info.Offset) / EventRecordSize ||
+          info.Offset + getChunkSize( static_cast<size_t>(info.RecordNum) ) > Header.IndexOffset) {
+         File.close();
+         ChunkIndex = ColumnSpan<EventLogChunkInfo>();
+         return false;
+      }
+   }
+   return true;
+}
+
+EventChunk EventLogReader::getChunk(size_t i) const
+{
+   const EventLogChunkInfo& info = ChunkIndex[i];
+   const auto n = static_cast<size_t>(info.RecordNum);
+   const char* ptr = File.data() + info.Offset;
+
+   EventChunk chunk;
+   chunk.Size = n;
+   chunk.Timestamps = ColumnSpan<double>(reinterpret_cast<const double*>(ptr), n);
+   ptr += n * sizeof( double );
+   chunk.CameraIndices = ColumnSpan<int32_t>(reinterpret_cast<const int32_t*>(ptr), n);
+   ptr += n * sizeof( int32_t );
+   chunk.CameraX = ColumnSpan<float>(reinterpret_cast<const float*>(ptr), n);
+   ptr += n * sizeof( float );
+   chunk.CameraY = ColumnSpan<float>(reinterpret_cast<const float*>(ptr), n);
+   ptr += n * sizeof( float );
+   chunk.Confidences = ColumnSpan<float>(reinterpret_cast<const float*>(ptr), n);
+   ptr += n * sizeof( float );
+   chunk.WorldX = ColumnSpan<float>(reinterpret_cast<const float*>(ptr), n);
+   ptr += n * sizeof( float );
+   chunk.WorldY = ColumnSpan<float>(reinterpret_cast<const float*>(ptr), n);
+   ptr += n * sizeof( float );
+   chunk.ZoneIndices = ColumnSpan<int32_t>(reinterpret_cast<const int32_t*>(ptr), n);
+   ptr += n * sizeof( int32_t );
+   chunk.Validities = ColumnSpan<uint8_t>(reinterpret_cast<const uint8_t*>(ptr), n);
+   return chunk;
+}
\ No newline at end of file
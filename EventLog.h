@@ -0,0 +1,138 @@
+/*
+ * Author: Emoy Kim
+ * E-mail: emoy.kim_AT_gmail.com
+ *
+ * This code is a free software; it can be freely used, changed and redistributed.
+ * If you use any version of the code, please reference the code.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Detection.h"
+#include "MappedFile.h"
+
+// Columnar binary log of detections and their locations, stored in the native (little-endian) byte order.
+//
+//  [header] [chunk 0] [chunk 1] ... [chunk index]
+//
+// A chunk has up to ChunkCapacity records, and each column of a chunk is contiguous in this order:
+// timestamps(double), camera indices(int32), camera x, camera y, confidences, world x(m), world y(m) (float),
+// zone indices(int32), validities(uint8). Chunks start at multiples of 8 bytes, so every column is aligned.
+// The chunk index at the end has the offset, the record number and the time range of each chunk.
+struct EventLogHeader
+{
+   char Magic[8];
+   uint32_t Version;
+   uint32_t ChunkCapacity;
+   uint64_t RecordNum;
+   uint64_t ChunkNum;
+   uint64_t IndexOffset;
+};
+
+struct EventLogChunkInfo
+{
+   uint64_t Offset;
+   uint64_t RecordNum;
+   double MinTimestamp;
+   double MaxTimestamp;
+};
+
+template<typename T>
+struct ColumnSpan
+{
+   const T* Data;
+   size_t Size;
+
+   ColumnSpan() : Data( nullptr ), Size( 0 ) {}
+   ColumnSpan(const T* data, size_t size) : Data( data ), Size( size ) {}
+   const T& operator[](size_t i) const { return Data[i]; }
+   const T* begin() const { return Data; }
+   const T* end() const { return Data + Size; }
+};
+
+// Columns of a chunk which point into the mapped file without any copy.
+struct EventChunk
+{
+   size_t Size;
+   ColumnSpan<double> Timestamps;
+   ColumnSpan<int32_t> CameraIndices;
+   ColumnSpan<float> CameraX;
+   ColumnSpan<float> CameraY;
+   ColumnSpan<float> Confidences;
+   ColumnSpan<float> WorldX;
+   ColumnSpan<float> WorldY;
+   ColumnSpan<int32_t> ZoneIndices;
+   ColumnSpan<uint8_t> Validities;
+
+   EventChunk() : Size( 0 ) {}
+
+   Detection getDetection(size_t i) const
+   {
+      return { Timestamps[i], CameraIndices[i], cv::Point2f(CameraX[i], CameraY[i]), Confidences[i] };
+   }
+   LocalizedDetection getLocalizedDetection(size_t i) const
+   {
+      LocalizedDetection localized;
+      localized.Source = getDetection( i );
+      localized.ActualPositionInMeter = cv::Point2f(WorldX[i], WorldY[i]);
+      localized.ZoneIndex = ZoneIndices[i];
+      localized.IsValid = Validities[i] != 0;
+      return localized;
+   }
+};
+
+bool isEventLogPath(const std::string& path);
+
+class EventLogWriter
+{
+public:
+   explicit EventLogWriter(size_t chunk_capacity = 65536);
+   ~EventLogWriter() { close(); }
+
+   bool open(const std::string& path);
+   bool close();
+   bool isOpen() const { return File.is_open(); }
+   void write(const Detection& detection);
+   void write(const LocalizedDetection& localized);
+
+private:
+   std::ofstream File;
+   uint32_t ChunkCapacity;
+   uint64_t RecordNum;
+   std::vector<EventLogChunkInfo> ChunkIndex;
+   std::vector<double> Timestamps;
+   std::vector<int32_t> CameraIndices;
+   std::vector<float> CameraX;
+   std::vector<float> CameraY;
+   std::vector<float> Confidences;
+   std::vector<float> WorldX;
+   std::vector<float> WorldY;
+   std::vector<int32_t> ZoneIndices;
+   std::vector<uint8_t> Validities;
+
+   void flushChunk();
+};
+
+class EventLogReader
+{
+public:
+   EventLogReader() : Header() {}
+   ~EventLogReader() = default;
+
+   bool open(const std::string& path);
+   size_t getRecordNum() const { return static_cast<size_t>(Header.RecordNum); }
+   size_t getChunkNum() const { return ChunkIndex.Size; }
+   const EventLogChunkInfo& getChunkInfo(size_t i) const { return ChunkIndex[i]; }
+   EventChunk getChunk(size_t i) const;
+
+private:
+   MappedFile File;
+   EventLogHeader Header;
+   ColumnSpan<EventLogChunkInfo> ChunkIndex;
+};
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include "FusionIngest.h"
+
+FusionIngest::FusionIngest(
+   const LocationDetection& location_detector,
+   int camera_num,
+   size_t queue_capacity,
+   double max_lateness
+) : LocationDetector( location_detector ), MaxLateness( max_lateness ), IsRunning( false ), FusedNum( 0 )
+{
+   for (int i = 0; i < camera_num; ++i) Cameras.emplace_back( std::make_unique<CameraChannel>( queue_capacity ) );
+}
+
+size_t FusionIngest::submit(int camera_index, const std::vector<Detection>& detections)
+{
+   if (camera_index < 0 || camera_index >= static_cast<int>(Cameras.size())) return 0;
+
+   CameraChannel& camera = *Cameras[camera_index];
+   LocationDetector.detectLocations( camera.Localized, detections );
+
+   size_t pushed = 0;
+   uint64_t overflow_num = 0;
+   double watermark = camera.Watermark.load( std::memory_order_relaxed );
+   for (const auto& localized : camera.Localized) {
+      watermark = std::max( watermark, localized.Source.Timestamp );
+      if (!localized.IsValid) continue;
+
+      if (camera.Queue.tryPush( localized )) pushed++;
+      else overflow_num++;
+   }
+   if (overflow_num > 0) camera.OverflowNum.fetch_add( overflow_num, std::memory_order_relaxed );
+   camera.Watermark.store( watermark, std::memory_order_release );
+   return pushed;
+}
+
+void FusionIngest::fuse(FusionHandler handler)
+{
+   constexpr size_t batch_size = 1024;
+   std::vector<LocalizedDetection> fused;
+   fused.reserve( batch_size );
+   const auto flush = [&]()
+   {
+      if (fused.empty()) return;
+      handler( fused );
+      FusedNum.fetch_add( fused.size(), std::memory_order_relaxed );
+      fused.clear();
+   };
+
+   while (true) {
+      const bool is_stopping = !IsRunning.load( std::memory_order_acquire );
+
+      int earliest = -1;
+      double earliest_timestamp = std::numeric_limits<double>::infinity();
+      double latest_watermark = -std::numeric_limits<double>::infinity();
+      for (size_t c = 0; c < Cameras.size(); ++c) {
+         latest_watermark = std::max( latest_watermark, Cameras[c]->Watermark.load( std::memory_order_acquire ) );
+         const LocalizedDetection* head = Cameras[c]->Queue.front();
+         if (head != nullptr && head->Source.Timestamp < earliest_timestamp) {
+            earliest = static_cast<int>(c);
+            earliest_timestamp = head->Source.Timestamp;
+         }
+      }
+      if (earliest < 0) {
+         flush();
+         if (is_stopping) break;
+         std::this_thread::sleep_for( std::chrono::microseconds(50) );
+         continue;
+      }
+
+      // the watermark is loaded before the queue is checked again. a producer pushes its records before it stores
+      // the watermark, so an empty queue after a later watermark means that the camera has nothing earlier.
+      bool is_releasable = is_stopping || earliest_timestamp <= latest_watermark - MaxLateness;
+      if (!is_releasable) {
+         is_releasable = true;
+         for (size_t c = 0; c < Cameras.size(); ++c) {
+            if (static_cast<int>(c) == earliest) continue;
+
+            const double watermark = Cameras[c]->Watermark.load( std::memory_order_acquire );
+            const LocalizedDetection* head = Cameras[c]->Queue.front();
+            if (head != nullptr ? head->Source.Timestamp < earliest_timestamp : watermark < earliest_timestamp) {
+               is_releasable = false;
+               break;
+            }
+         }
+      }
+
+      if (is_releasable) {
+         SpscQueue<LocalizedDetection>& queue = Cameras[earliest]->Queue;
+         fused.emplace_back( *queue.front() );
+         queue.pop();
+         if (fused.size() == batch_size) flush();
+      }
+      else {
+         flush();
+         std::this_thread::sleep_for( std::chrono::microseconds(50) );
+      }
+   }
+}
+
+void FusionIngest::start(FusionHandler handler)
+{
+   if (IsRunning.exchange( true )) return;
+   FusionWorker = std::thread( &FusionIngest::fuse, this, std::move( handler ) );
+}
+
+void FusionIngest::stop()
+{
+   IsRunning.store( false, std::memory_order_release );
+   if (FusionWorker.joinable()) FusionWorker.join();
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+/*
+ * Author: Emoy Kim
+ * E-mail: emoy.kim_AT_gmail.com
+ *
+ * This code is a free software; it can be freely used, changed and redistributed.
+ * If you use any version of the code, please reference the code.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <functional>
+#include <chrono>
+#include <limits>
+
+#include "LocationDetection.h"
+#include "SpscQueue.h"
+
+// Ingestion front end where each camera has its own producer thread and one fusion worker consumes all of them.
+// A producer localizes its detections with LocationDetection::detectLocations() and pushes them into the ring of its
+// camera without any lock. When the ring is full, the detection is dropped and counted as an overflow.
+// The fusion worker merges the rings in timestamp order and passes batches of the merged detections to the handler.
+// A detection is released when no camera can deliver an earlier one any more: every other camera either has
+// a later detection queued or has already been seen at a later time, or the detection is older than the latest
+// timestamp of all cameras by MaxLateness. The timestamps of each camera should not decrease.
+class FusionIngest
+{
+public:
+   using FusionHandler = std::function<void(const std::vector<LocalizedDetection>&)>;
+
+   FusionIngest(
+      const LocationDetection& location_detector,
+      int camera_num,
+      size_t queue_capacity = 4096,
+      double max_lateness = 0.5
+   );
+   ~FusionIngest() { stop(); }
+
+   // called only by the producer thread of the camera.
+   size_t submit(int camera_index, const std::vector<Detection>& detections);
+
+   void start(FusionHandler handler);
+   void stop(); // the queued detections are all passed to the handler before it returns.
+
+   uint64_t getOverflowNum(int camera_index) const { return Cameras[camera_index]->OverflowNum.load( std::memory_order_relaxed ); }
+   uint64_t getFusedNum() const { return FusedNum.load( std::memory_order_relaxed ); }
+
+private:
+   struct CameraChannel
+   {
+      SpscQueue<LocalizedDetection> Queue;
+      std::atomic<double> Watermark; // the latest timestamp pushed by the producer
+      std::atomic<uint64_t> OverflowNum;
+      std::vector<LocalizedDetection> Localized; // scratch of the producer
+
+      explicit CameraChannel(size_t capacity) :
+         Queue( capacity ), Watermark( -std::numeric_limits<double>::infinity() ), OverflowNum( 0 ) {}
+   };
+
+   const LocationDetection& LocationDetector;
+   double MaxLateness;
+   std::vector<std::unique_ptr<CameraChannel>> Cameras;
+   std::atomic<bool> IsRunning;
+   std::atomic<uint64_t> FusedNum;
+   std::thread FusionWorker;
+
+   void fuse(FusionHandler handler);
+};
\ No newline at end of file
@@ -0,0 +1,158 @@
+#include "GeofenceEngine.h"
+
+GeofenceEngine::GeofenceEngine(
+   const LocationDetection& location_detector,
+   double max_dwell_time,
+   size_t queue_capacity,
+   float cell_size_in_meter
+) : LocationDetector( location_detector ), Scene( location_detector.getZoneScene() ), MeterToPixel( location_detector.getMeterToPixel() ),
+   MaxDwellTime( max_dwell_time ), CellSize( cell_size_in_meter * location_detector.getMeterToPixel() ), Frame( 0 ),
+   Events( queue_capacity ), DroppedNum( 0 )
+{
+   buildGrid();
+}
+
+void GeofenceEngine::buildGrid()
+// the grid covers the bounding boxes of all zones, and each cell lists the zones whose bounding boxes overlap it.
+// a zone without edges is never entered, and its infinite bounds are skipped.
+{
+   ZoneVersion = LocationDetector.getZoneVersion();
+   const int zone_num = Scene.getZoneNum();
+   GridOrigin = cv::Point();
+   GridSize = cv::Size();
+   CellOffsets.assign( 1, 0 );
+   CellZones.clear();
+
+   bool has_zone = false;
+   float min_x = std::numeric_limits<float>::max(), min_y = std::numeric_limits<float>::max();
+   float max_x = std::numeric_limits<float>::lowest(), max_y = std::numeric_limits<float>::lowest();
+   for (int z = 0; z < zone_num; ++z) {
+      if (!Scene.hasEdges( z )) continue;
+      has_zone = true;
+      min_x = std::min( min_x, Scene.MinX[z] );
+      min_y = std::min( min_y, Scene.MinY[z] );
+      max_x = std::max( max_x, Scene.MaxX[z] );
+      max_y = std::max( max_y, Scene.MaxY[z] );
+   }
+   if (!has_zone) return;
+
+   GridOrigin = cv::Point(static_cast<int>(floor( min_x / CellSize )), static_cast<int>(floor( min_y / CellSize )));
+   GridSize = cv::Size(
+      static_cast<int>(floor( max_x / CellSize )) - GridOrigin.x + 1,
+      static_cast<int>(floor( max_y / CellSize )) - GridOrigin.y + 1
+   );
+
+   const auto forEachCell = [this](int z, const std::function<void(int)>& function)
+   {
+      if (!Scene.hasEdges( z )) return;
+      const int x0 = static_cast<int>(floor( Scene.MinX[z] / CellSize )) - GridOrigin.x;
+      const int y0 = static_cast<int>(floor( Scene.MinY[z] / CellSize )) - GridOrigin.y;
+      const int x1 = static_cast<int>(floor( Scene.MaxX[z] / CellSize )) - GridOrigin.x;
+      const int y1 = static_cast<int>(floor( Scene.MaxY[z] / CellSize )) - GridOrigin.y;
+      for (int y = y0; y <= y1; ++y) {
+         for (int x = x0; x <= x1; ++x) function( y * GridSize.width + x );
+      }
+   };
+   CellOffsets.assign( GridSize.area() + 1, 0 );
+   for (int z = 0; z < zone_num; ++z) forEachCell( z, [this](int cell) { CellOffsets[cell + 1]++; } );
+   for (int i = 0; i < GridSize.area(); ++i) CellOffsets[i + 1] += CellOffsets[i];
+
+   std::vector<int> next(CellOffsets.begin(), CellOffsets.end() - 1);
+   CellZones.resize( CellOffsets.back() );
+   for (int z = 0; z < zone_num; ++z) forEachCell( z, [&](int cell) { CellZones[next[cell]++] = z; } );
+}
+
+int GeofenceEngine::getCell(const cv::Point2f& point) const
+{
+   const int x = static_cast<int>(floor( point.x / CellSize )) - GridOrigin.x;
+   const int y = static_cast<int>(floor( point.y / CellSize )) - GridOrigin.y;
+   if (x < 0 || y < 0 || x >= GridSize.width || y >= GridSize.height) return -1;
+   return y * GridSize.width + x;
+}
+
+void GeofenceEngine::emit(GeofenceEventType type, int track_id, const Membership& membership, double timestamp)
+{
+   const GeofenceEvent event{
+      type, track_id, membership.ZoneIndex, timestamp, type == GeofenceEventType::Enter ? 0.0 : timestamp - membership.EnterTime
+   };
+   if (!Events.tryPush( event )) DroppedNum.fetch_add( 1, std::memory_order_relaxed );
+}
+
+void GeofenceEngine::updateTrack(TrackState& state, int track_id, const cv::Point2f& point, double timestamp)
+{
+   auto& memberships = state.Memberships;
+   for (size_t i = 0; i < memberships.size();) {
+      if (!Scene.isInsideZone( point, memberships[i].ZoneIndex )) {
+         emit( GeofenceEventType::Exit, track_id, memberships[i], timestamp );
+         memberships[i] = memberships.back();
+         memberships.pop_back();
+         continue;
+      }
+      if (!memberships[i].IsDwellReported && timestamp - memberships[i].EnterTime > MaxDwellTime) {
+         emit( GeofenceEventType::DwellExceeded, track_id, memberships[i], timestamp );
+         memberships[i].IsDwellReported = true;
+      }
+      ++i;
+   }
+
+   const int cell = getCell( point );
+   if (cell < 0) return;
+
+   for (int c = CellOffsets[cell]; c < CellOffsets[cell + 1]; ++c) {
+      const int zone = CellZones[c];
+      const auto is_member = std::any_of(
+         memberships.begin(), memberships.end(),
+         [zone](const Membership& membership) { return membership.ZoneIndex == zone; }
+      );
+      if (is_member || !Scene.isInsideZone( point, zone )) continue;
+
+      memberships.push_back( { zone, timestamp, false } );
+      emit( GeofenceEventType::Enter, track_id, memberships.back(), timestamp );
+   }
+}
+
+void GeofenceEngine::update(const std::vector<Track>& tracks, double timestamp)
+{
+   if (LocationDetector.getZoneVersion() != ZoneVersion) {
+      buildGrid();
+      const int zone_num = Scene.getZoneNum();
+      for (auto& track_state : TrackStates) {
+         auto& memberships = track_state.second.Memberships;
+         memberships.erase(
+            std::remove_if(
+               memberships.begin(), memberships.end(),
+               [zone_num](const Membership& membership) { return membership.ZoneIndex >= zone_num; }
+            ),
+            memberships.end()
+         );
+      }
+   }
+
+   Frame++;
+   for (const auto& track : tracks) {
+      TrackState& state = TrackStates[track.Id];
+      state.LastFrame = Frame;
+      updateTrack( state, track.Id, track.PositionInMeter * MeterToPixel, timestamp );
+   }
+
+   for (auto it = TrackStates.begin(); it != TrackStates.end();) {
+      if (it->second.LastFrame == Frame) {
+         ++it;
+         continue;
+      }
+      for (const auto& membership : it->second.Memberships) {
+         emit( GeofenceEventType::Exit, it->first, membership, timestamp );
+      }
+      it = TrackStates.erase( it );
+   }
+}
+
+bool GeofenceEngine::popEvent(GeofenceEvent& event)
+{
+   const GeofenceEvent* front = Events.front();
+   if (front == nullptr) return false;
+
+   event = *front;
+   Events.pop();
+   return true;
+}
\ No newline at end of file
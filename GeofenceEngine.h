@@ -0,0 +1,88 @@
+/*
+ * Author: Emoy Kim
+ * E-mail: emoy.kim_AT_gmail.com
+ *
+ * This code is a free software; it can be freely used, changed and redistributed.
+ * If you use any version of the code, please reference the code.
+ *
+ */
+
+#pragma once
+
+#include <unordered_map>
+#include <functional>
+
+#include "LocationDetection.h"
+#include "MultiTargetTracker.h"
+#include "SpscQueue.h"
+
+enum class GeofenceEventType { Enter, Exit, DwellExceeded };
+
+struct GeofenceEvent
+{
+   GeofenceEventType Type;
+   int TrackId;
+   int ZoneIndex;
+   double Timestamp;
+   double DwellTime; // how long the track has been in the zone, which is 0 for Enter
+};
+
+// Emits an event when a track enters or exits a zone, or stays in a zone longer than the maximum dwell time.
+// Zones may overlap, so a track can be in several zones at once. Only the zones whose bounding boxes overlap
+// the grid cell of the track and the zones which the track is already in are tested in each update.
+// The grid is rebuilt when the zones of the location detector change, e.g. by setZoneTolerance(), and the memberships
+// of the zones which no longer exist are dropped. A track which disappears from the tracks exits all its zones. Events are pushed into a bounded lock-free queue
+// for one consumer thread, and they are dropped and counted when the queue is full.
+class GeofenceEngine
+{
+public:
+   GeofenceEngine(
+      const LocationDetection& location_detector,
+      double max_dwell_time,
+      size_t queue_capacity = 65536,
+      float cell_size_in_meter = 2.0f
+   );
+   ~GeofenceEngine() = default;
+
+   // called by one thread with all tracks at the timestamp.
+   void update(const std::vector<Track>& tracks, double timestamp);
+
+   // called by one consumer thread.
+   bool popEvent(GeofenceEvent& event);
+
+   uint64_t getDroppedNum() const { return DroppedNum.load( std::memory_order_relaxed ); }
+
+private:
+   struct Membership
+   {
+      int ZoneIndex;
+      double EnterTime;
+      bool IsDwellReported;
+   };
+
+   struct TrackState
+   {
+      uint64_t LastFrame;
+      std::vector<Membership> Memberships;
+   };
+
+   const LocationDetection& LocationDetector;
+   const ZoneScene& Scene;
+   uint64_t ZoneVersion; // of the zones when the grid is built
+   float MeterToPixel;
+   double MaxDwellTime;
+   float CellSize; // in pixel
+   cv::Point GridOrigin;
+   cv::Size GridSize;
+   std::vector<int> CellOffsets; // zones of the i-th cell are CellZones[CellOffsets[i]] ~ CellZones[CellOffsets[i + 1] - 1]
+   std::vector<int> CellZones;
+   uint64_t Frame;
+   std::unordered_map<int, TrackState> TrackStates;
+   SpscQueue<GeofenceEvent> Events;
+   std::atomic<uint64_t> DroppedNum;
+
+   void buildGrid();
+   int getCell(const cv::Point2f& point) const;
+   void emit(GeofenceEventType type, int track_id, const Membership& membership, double timestamp);
+   void updateTrack(TrackState& state, int track_id, const cv::Point2f& point, double timestamp);
+};
\ No newline at end of file
@@ -0,0 +1,20 @@
+#include "GroundSamplingMap.h"
+
+cv::Vec4f GroundSamplingMap::getJacobian(const cv::Point2f& camera_point) const
+{
+   const auto x = static_cast<int>(camera_point.x) / CellSize;
+   const auto y = static_cast<int>(camera_point.y) / CellSize;
+   if (camera_point.x < 0.0f || camera_point.y < 0.0f || x >= Jacobians.cols || y >= Jacobians.rows) return {};
+   return Jacobians.at<cv::Vec4f>(y, x);
+}
+
+cv::Vec3f GroundSamplingMap::getCovariance(const cv::Vec4f& j)
+{
+   return { j[0] * j[0] + j[1] * j[1], j[0] * j[2] + j[1] * j[3], j[2] * j[2] + j[3] * j[3] };
+}
+
+float GroundSamplingMap::getMeterPerPixel(const cv::Vec4f& j)
+{
+   const float area = std::abs( j[0] * j[3] - j[1] * j[2] );
+   return area > 0.0f ? std::sqrt( area ) : std::numeric_limits<float>::infinity();
+}
\ No newline at end of file
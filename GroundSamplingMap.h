@@ -0,0 +1,34 @@
+/*
+ * Author: Emoy Kim
+ * E-mail: emoy.kim_AT_gmail.com
+ *
+ * This code is a free software; it can be freely used, changed and redistributed.
+ * If you use any version of the code, please reference the code.
+ *
+ */
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+// Jacobian of the camera-to-world transform at each cell of a camera, i.e. how many meters on the floor a pixel spans.
+// A cell has (dx/du, dx/dv, dy/du, dy/dv) in meter per pixel, where (u, v) is the camera point and (x, y) is
+// the position in meter, and it is 0 where the floor is not seen. The covariance of a localized point for
+// a pixel noise of sigma is sigma^2 * J * J^t, so it is looked up instead of differentiating for each detection.
+struct GroundSamplingMap
+{
+   int CellSize;     // in pixels of the camera
+   cv::Mat Jacobians; // CV_32FC4, one element per cell
+
+   GroundSamplingMap() : CellSize( 8 ) {}
+
+   cv::Vec4f getJacobian(const cv::Point2f& camera_point) const;
+
+   // (variance of x, covariance of x and y, variance of y) in square meters for one pixel of noise.
+   cv::Vec3f getCovariance(const cv::Point2f& camera_point) const { return getCovariance( getJacobian( camera_point ) ); }
+   static cv::Vec3f getCovariance(const cv::Vec4f& jacobian);
+
+   // the side of the square on the floor which a pixel covers, and infinity if the floor is not seen.
+   float getMeterPerPixel(const cv::Point2f& camera_point) const { return getMeterPerPixel( getJacobian( camera_point ) ); }
+   static float getMeterPerPixel(const cv::Vec4f& jacobian);
+};
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include "HeatmapAccumulator.h"
+
+HeatmapAccumulator::HeatmapAccumulator(
+   const LocationDetection& location_detector,
+   int thread_num,
+   float cell_size_in_meter,
+   double half_life,
+   int tile_size
+) : LocationDetector( location_detector ), CellSize( cell_size_in_meter ),
+   DecayRate( half_life > 0.0 ? log( 2.0 ) / half_life : 0.0 ), TileSize( tile_size )
+{
+   const cv::Size2f floor_size = location_detector.getActualFloorSize();
+   GridSize = cv::Size(
+      std::max( static_cast<int>(ceil( floor_size.width / CellSize )), 1 ),
+      std::max( static_cast<int>(ceil( floor_size.height / CellSize )), 1 )
+   );
+   TileGridSize = cv::Size((GridSize.width + TileSize - 1) / TileSize, (GridSize.height + TileSize - 1) / TileSize);
+   Heatmap = cv::Mat::zeros( GridSize, CV_32FC1 );
+   TileTimestamps.assign( TileGridSize.area(), -std::numeric_limits<double>::infinity() );
+
+   const auto initialize = [this](PartialRaster& partial)
+   {
+      partial.Cells.assign( GridSize.area(), 0.0f );
+      partial.IsTileTouched.assign( TileGridSize.area(), 0 );
+   };
+   for (int i = 0; i < thread_num; ++i) {
+      Partials.emplace_back( std::make_unique<PartialRaster>() );
+      initialize( *Partials.back() );
+   }
+   initialize( Merging );
+}
+
+void HeatmapAccumulator::add(int thread, const std::vector<LocalizedDetection>& detections)
+{
+   PartialRaster& partial = *Partials[thread];
+   std::lock_guard<std::mutex> lock( partial.Mutex );
+   for (const auto& localized : detections) {
+      if (!localized.IsValid) continue;
+
+      const auto x = static_cast<int>(localized.ActualPositionInMeter.x / CellSize);
+      const auto y = static_cast<int>(localized.ActualPositionInMeter.y / CellSize);
+      if (x < 0 || y < 0 || x >= GridSize.width || y >= GridSize.height) continue;
+
+      partial.Cells[y * GridSize.width + x] += 1.0f;
+      const int tile = getTile( x, y );
+      if (!partial.IsTileTouched[tile]) {
+         partial.IsTileTouched[tile] = 1;
+         partial.TouchedTiles.emplace_back( tile );
+      }
+   }
+}
+
+void HeatmapAccumulator::decayTile(int tile, double timestamp)
+{
+   const double elapsed = timestamp - TileTimestamps[tile];
+   TileTimestamps[tile] = timestamp;
+   if (DecayRate == 0.0 || elapsed <= 0.0 || std::isinf( elapsed )) return;
+
+   const auto factor = static_cast<float>(exp( -DecayRate * elapsed ));
+   const int x0 = (tile % TileGridSize.width) * TileSize;
+   const int y0 = (tile / TileGridSize.width) * TileSize;
+   const int x1 = std::min( x0 + TileSize, GridSize.width );
+   const int y1 = std::min( y0 + TileSize, GridSize.height );
+   for (int y = y0; y < y1; ++y) {
+      auto* row = Heatmap.ptr<float>(y);
+      for (int x = x0; x < x1; ++x) row[x] *= factor;
+   }
+}
+
+void HeatmapAccumulator::merge(double timestamp)
+// the buffers are swapped with the empty ones under the lock, so an ingest thread waits only for the swap.
+{
+   for (auto& partial : Partials) {
+      {
+         std::lock_guard<std::mutex> lock( partial->Mutex );
+         std::swap( partial->Cells, Merging.Cells );
+         std::swap( partial->TouchedTiles, Merging.TouchedTiles );
+         std::swap( partial->IsTileTouched, Merging.IsTileTouched );
+      }
+
+      for (const auto& tile : Merging.TouchedTiles) {
+         decayTile( tile, timestamp );
+         const int x0 = (tile % TileGridSize.width) * TileSize;
+         const int y0 = (tile / TileGridSize.width) * TileSize;
+         const int x1 = std::min( x0 + TileSize, GridSize.width );
+         const int y1 = std::min( y0 + TileSize, GridSize.height );
+         for (int y = y0; y < y1; ++y) {
+            auto* row = Heatmap.ptr<float>(y);
+            float* cells = Merging.Cells.data() + y * GridSize.width;
+            for (int x = x0; x < x1; ++x) {
+               row[x] += cells[x];
+               cells[x] = 0.0f;
+            }
+         }
+         Merging.IsTileTouched[tile] = 0;
+      }
+      Merging.TouchedTiles.clear();
+   }
+}
+
+void HeatmapAccumulator::exportRaw(cv::Mat& heatmap, double timestamp)
+{
+   for (int tile = 0; tile < TileGridSize.area(); ++tile) decayTile( tile, timestamp );
+   Heatmap.copyTo( heatmap );
+}
+
+void HeatmapAccumulator::exportOverlay(cv::Mat& overlay, double timestamp)
+{
+   cv::Mat raw;
+   exportRaw( raw, timestamp );
+   const cv::Mat& floor = LocationDetector.getFloorImage();
+   if (floor.empty()) {
+      overlay.release();
+      return;
+   }
+
+   double max_value = 0.0;
+   cv::minMaxLoc( raw, nullptr, &max_value );
+   cv::Mat normalized, colorized;
+   raw.convertTo( normalized, CV_8UC1, max_value > 0.0 ? 255.0 / max_value : 0.0 );
+   cv::resize( normalized, normalized, floor.size(), 0.0, 0.0, cv::INTER_LINEAR );
+   cv::applyColorMap( normalized, colorized, cv::COLORMAP_JET );
+
+   // cells never visited are left as the floor image.
+   cv::addWeighted( floor, 0.4, colorized, 0.6, 0.0, overlay );
+   floor.copyTo( overlay, normalized == 0 );
+}
\ No newline at end of file
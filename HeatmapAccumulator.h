@@ -0,0 +1,64 @@
+/*
+ * Author: Emoy Kim
+ * E-mail: emoy.kim_AT_gmail.com
+ *
+ * This code is a free software; it can be freely used, changed and redistributed.
+ * If you use any version of the code, please reference the code.
+ *
+ */
+
+#pragma once
+
+#include <mutex>
+#include <memory>
+
+#include "LocationDetection.h"
+
+// Accumulates localized points on a grid over the floor, whose cell is cell_size_in_meter wide.
+// Each ingest thread adds points to its own partial raster, and merge() folds the partial rasters into the heatmap
+// periodically. The points in a partial raster are regarded as added at the time of the merge.
+// The heatmap decays exponentially with the half life, but the decay is applied to a tile of cells only when
+// the tile is merged into or exported, so a tick never touches all cells.
+class HeatmapAccumulator
+{
+public:
+   HeatmapAccumulator(
+      const LocationDetection& location_detector,
+      int thread_num,
+      float cell_size_in_meter = 0.25f,
+      double half_life = 0.0, // in seconds, and 0 means no decay
+      int tile_size = 32      // in cells
+   );
+   ~HeatmapAccumulator() = default;
+
+   // called only by the thread of the partial raster.
+   void add(int thread, const std::vector<LocalizedDetection>& detections);
+
+   // called by one thread which merges and exports.
+   void merge(double timestamp);
+   void exportRaw(cv::Mat& heatmap, double timestamp);     // CV_32FC1, one pixel per cell
+   void exportOverlay(cv::Mat& overlay, double timestamp); // colorized heatmap over the floor image
+
+private:
+   struct PartialRaster
+   {
+      std::mutex Mutex; // held by the ingest thread while adding, and by merge() only to swap the buffers
+      std::vector<float> Cells;
+      std::vector<int> TouchedTiles;
+      std::vector<uchar> IsTileTouched;
+   };
+
+   const LocationDetection& LocationDetector;
+   float CellSize;
+   double DecayRate; // ln(2) / half life
+   int TileSize;
+   cv::Size GridSize;
+   cv::Size TileGridSize;
+   cv::Mat Heatmap;
+   std::vector<double> TileTimestamps; // until when each tile has been decayed
+   std::vector<std::unique_ptr<PartialRaster>> Partials;
+   PartialRaster Merging;              // the buffers swapped out of a partial raster
+
+   int getTile(int cell_x, int cell_y) const { return (cell_y / TileSize) * TileGridSize.width + cell_x / TileSize; }
+   void decayTile(int tile, double timestamp);
+};
\ No newline at end of file
@@ -1,15 +1,24 @@
 #include "LocationDetection.h"
 
-LocationDetection::LocationDetection(float actual_width, float actual_height, const std::vector<CustomizedZone>& zones) :
-   ActualFloorWidth( actual_width ), ActualFloorHeight( actual_height ), DefaultAltitude( 1.0f )
+LocationDetection::LocationDetection(
+   float actual_width, 
+   float actual_height, 
+   const std::vector<CustomizedZone>& zones, 
+   float zone_tolerance_in_meter,
+   bool customize_zones_if_empty
+) : ActualFloorWidth( actual_width ), ActualFloorHeight( actual_height ), DefaultAltitude( 1.0f ), 
+    ZoneTolerance( zone_tolerance_in_meter ), ZoneVersion( 0 )
 {
    Instance = this;
 
    FloorImage = cv::imread( std::string(CMAKE_SOURCE_DIR) + "/floor.jpg" );
    if (!FloorImage.empty()) {
       MeterToPixel = static_cast<float>(FloorImage.cols) / ActualFloorWidth;
-      if (zones.empty()) customizeZones();
-      else CustomizedZones = zones;
+      if (zones.empty() && customize_zones_if_empty) customizeZones();
+      else {
+         CustomizedZones = zones;
+         updateZoneArrangement();
+      }
    }
    else std::cout << "Cannot Load the Image...\n";
 }
@@ -39,12 +48,7 @@ void LocationDetection::customizeZonesCallback(int evt, int x, int y, int flags,
    if (evt == cv::EVENT_LBUTTONDOWN) {
       cv::Mat viewer = static_cast<cv::Mat*>(param)->clone();
       if (complete || isEndPoint( x, y )) {
-         if (!complete) {
-            std::vector<cv::Point> convex;
-            cv::convexHull( ClickedPoints, convex );
-            ClickedPoints = std::move( convex );
-            complete = true;
-         }
+         complete = true;
          renderZone( viewer, ClickedPoints, GREEN_COLOR );
       }
       else {
@@ -83,30 +87,160 @@ void LocationDetection::customizeZones()
          std::cin >> altitude;
          CustomizedZones.emplace_back( altitude, ClickedPoints );
 
+         renderZone( FloorImage, ClickedPoints );
+      }
+      else if (key == 'h' && !CustomizedZones.empty() && ClickedPoints.size() > 2) {
+         CustomizedZones.back().Holes.emplace_back( ClickedPoints );
+
          renderZone( FloorImage, ClickedPoints );
       }
    }
+   updateZoneArrangement();
 }
 
-bool LocationDetection::isInsideZone(const cv::Point& point, const std::vector<cv::Point>& zone) const
+void LocationDetection::simplifyZone(std::vector<cv::Point>& simplified, const std::vector<cv::Point>& zone) const
+// Douglas-Peucker keeps every original vertex within the tolerance from the simplified boundary.
 {
-   if (zone.size() <= 2) return false;
-   
-   bool is_inside = false;
-   for (size_t i = 0, j = zone.size() - 1; i < zone.size(); j = i++) {
-      if (((zone[i].y <= point.y && point.y < zone[j].y) || (zone[j].y <= point.y && point.y < zone[i].y)) && 
-          (point.x < (zone[j].x - zone[i].x) * (point.y - zone[i].y) / (zone[j].y - zone[i].y) + zone[i].x)) 
-         is_inside = !is_inside;
+   const float epsilon = ZoneTolerance * MeterToPixel;
+   if (epsilon > 0.0f && zone.size() > 3) {
+      cv::approxPolyDP( zone, simplified, static_cast<double>(epsilon), true );
+      if (simplified.size() > 2) return;
+   }
+   simplified = zone;
+}
+
+void LocationDetection::updateZoneArrangement()
+{
+   SimplifiedZones.resize( CustomizedZones.size() );
+   for (size_t i = 0; i < CustomizedZones.size(); ++i) {
+      const CustomizedZone& zone = CustomizedZones[i];
+      CustomizedZone& simplified = SimplifiedZones[i];
+      simplified.Altitude = zone.Altitude;
+      simplifyZone( simplified.Zone, zone.Zone );
+      simplified.Holes.resize( zone.Holes.size() );
+      for (size_t h = 0; h < zone.Holes.size(); ++h) simplifyZone( simplified.Holes[h], zone.Holes[h] );
+   }
+   Arrangement.build( SimplifiedZones, FloorImage.size(), DefaultAltitude );
+   ZoneVersion++;
+   {
+      std::lock_guard<std::mutex> lock( FloorMaskMutex );
+      for (auto& mask : FloorMasks) mask.clear( cv::Size() );
+   }
+   for (int camera = 0; camera < LocalCameras.size(); ++camera) updateGroundSamplingMap( camera );
+}
+
+RunLengthMask LocationDetection::getValidFloorMask(int camera_index) const
+// a copy is returned, since the masks are cleared when the zones change and reallocated when a camera is set.
+{
+   if (camera_index < 0 || camera_index >= LocalCameras.size()) return {};
+
+   std::lock_guard<std::mutex> lock( FloorMaskMutex );
+   if (FloorMasks[camera_index].Size.empty()) updateFloorMask( camera_index );
+   return FloorMasks[camera_index];
+}
+
+void LocationDetection::updateFloorMask(int camera) const
+// the spans are found while scanning each row, so the dense mask is never made.
+{
+   RunLengthMask& mask = FloorMasks[camera];
+   const int width = LocalCameras.Widths[camera];
+   const int height = LocalCameras.Heights[camera];
+   mask.clear( cv::Size(width, height) );
+
+   cv::Point2f world_point;
+   for (int y = 0; y < height; ++y) {
+      int begin = -1;
+      for (int x = 0; x < width; ++x) {
+         const bool is_valid = getValidWorldPointFromCamera( world_point, cv::Point(x, y), camera );
+         if (is_valid && begin < 0) begin = x;
+         else if (!is_valid && begin >= 0) {
+            mask.addSpan( begin, x );
+            begin = -1;
+         }
+      }
+      if (begin >= 0) mask.addSpan( begin, width );
+      mask.endRow();
+   }
+}
+
+bool LocationDetection::differentiateCameraToWorld(
+   cv::Vec4f& jacobian,
+   const cv::Point& camera_point,
+   const cv::Point2f& world_point,
+   int camera
+) const
+// the central difference of the neighboring pixels on the level of the world point, which is the transformed
+// camera point, or the one-sided difference where a neighbor falls off the world map.
+{
+   const float altitude = getAltitudeOnWorldMap( static_cast<cv::Point>(world_point) );
+   const auto differentiate = [&](cv::Point2f& derivative, const cv::Point& step)
+   {
+      cv::Point2f forward, backward;
+      const bool has_forward = transformCameraToWorld( forward, camera_point + step, altitude, camera );
+      const bool has_backward = transformCameraToWorld( backward, camera_point - step, altitude, camera );
+      if (has_forward && has_backward) derivative = (forward - backward) * (0.5f / MeterToPixel);
+      else if (has_forward) derivative = (forward - world_point) / MeterToPixel;
+      else if (has_backward) derivative = (world_point - backward) / MeterToPixel;
+      else return false;
+      return true;
+   };
+   cv::Point2f d_du, d_dv;
+   if (!differentiate( d_du, cv::Point(1, 0) ) || !differentiate( d_dv, cv::Point(0, 1) )) return false;
+
+   jacobian = cv::Vec4f(d_du.x, d_dv.x, d_du.y, d_dv.y);
+   return true;
+}
+
+void LocationDetection::updateGroundSamplingMap(int camera)
+{
+   GroundSamplingMap& sampling_map = GroundSamplingMaps[camera];
+   const int cell_size = sampling_map.CellSize;
+   const int width = LocalCameras.Widths[camera];
+   const int height = LocalCameras.Heights[camera];
+   sampling_map.Jacobians = cv::Mat::zeros( (height + cell_size - 1) / cell_size, (width + cell_size - 1) / cell_size, CV_32FC4 );
+
+   cv::Point2f world_point;
+   for (int y = 0; y < sampling_map.Jacobians.rows; ++y) {
+      auto* row = sampling_map.Jacobians.ptr<cv::Vec4f>(y);
+      for (int x = 0; x < sampling_map.Jacobians.cols; ++x) {
+         const cv::Point center(
+            std::min( x * cell_size + cell_size / 2, width - 1 ),
+            std::min( y * cell_size + cell_size / 2, height - 1 )
+         );
+         if (getValidWorldPointFromCamera( world_point, center, camera )) {
+            differentiateCameraToWorld( row[x], center, world_point, camera );
+         }
+      }
    }
-   return is_inside;
 }
 
-void LocationDetection::renderCameraPositionOnWorldMap(const Camera& camera)
+cv::Vec4f LocationDetection::getGroundJacobian(const cv::Point2f& camera_point, const cv::Point2f& world_point, int camera) const
+// a cell whose center is off the floor is 0 in the raster, and then the camera point is differentiated on its own.
+{
+   cv::Vec4f jacobian = GroundSamplingMaps[camera].getJacobian( camera_point );
+   if (jacobian == cv::Vec4f() &&
+       !differentiateCameraToWorld( jacobian, static_cast<cv::Point>(camera_point), world_point, camera )) return {};
+   return jacobian;
+}
+
+void LocationDetection::setZoneTolerance(float zone_tolerance_in_meter)
+{
+   ZoneTolerance = zone_tolerance_in_meter;
+   if (!FloorImage.empty()) updateZoneArrangement();
+}
+
+float LocationDetection::getAltitudeOnWorldMap(const cv::Point& world_point) const
+{
+   const int region = Arrangement.locate( world_point );
+   return region >= 0 ? Arrangement.getAltitude( region ) : DefaultAltitude;
+}
+
+void LocationDetection::renderCameraPositionOnWorldMap(int camera)
 {
    const cv::Point3f origin_vector(0.0f, 0.0f, 135.0f);
    const cv::Scalar color(87, 7, 228);
 
-   const float half_fov = atan( static_cast<float>(camera.CameraView.cols) * 0.5f / camera.FocalLength );
+   const float half_fov = atan( LocalCameras.HalfWidths[camera] / LocalCameras.FocalLengths[camera] );
    const float cos_fov = cos( half_fov );
    const float sin_fov = sin( half_fov );
    const float cos_fov_neg = cos( -half_fov );
@@ -121,12 +255,12 @@ void LocationDetection::renderCameraPositionOnWorldMap(const Camera& camera)
       0.0f, 1.0f, 0.0f,
       sin_fov_neg, 0.0f,  cos_fov_neg
    );
-   const cv::Matx33f pan_inv = camera.PanningToCamera.inv();
-   const cv::Matx33f tilt_inv = camera.TiltingToCamera.inv();
+   const cv::Matx33f pan_inv = LocalCameras.PanningToCameras[camera].inv();
+   const cv::Matx33f tilt_inv = LocalCameras.TiltingToCameras[camera].inv();
    const cv::Point3f view_vector = tilt_inv * pan_inv * origin_vector;
    const cv::Point camera_in_world(
-      static_cast<int>(round( camera.Translation.z * MeterToPixel )), 
-      static_cast<int>(round( camera.Translation.x * MeterToPixel ))
+      static_cast<int>(round( LocalCameras.Translations[camera].z * MeterToPixel )), 
+      static_cast<int>(round( LocalCameras.Translations[camera].x * MeterToPixel ))
    );
    const cv::Point camera_direction = camera_in_world + cv::Point(
       static_cast<int>(round( view_vector.z )), static_cast<int>(round( view_vector.x ))
@@ -156,77 +290,55 @@ void LocationDetection::setCamera(
    const cv::Point2f& actual_position_in_meter
 )
 {
-   Camera camera;
-   camera.Index = camera_index;
-   camera.FocalLength = focal_length;
-   camera.PanAngle = pan_angle_in_degree * static_cast<float>(CV_PI) / 180.0f;
-   camera.TiltAngle = tilt_angle_in_degree * static_cast<float>(CV_PI) / 180.0f;
-   camera.Translation = { actual_position_in_meter.y, 0.0f, actual_position_in_meter.x };
-   camera.CameraHeight = camera_height_in_meter;
-   camera.Altitude = DefaultAltitude;
-   camera.CameraView = cv::Mat(height, width, CV_8UC3, WHITE_COLOR);
-   camera.Intrinsic = cv::Matx33f(
-      focal_length, 0.0f, static_cast<float>(width) * 0.5f,
-      0.0f, focal_length, static_cast<float>(height) * 0.5f,
-      0.0f, 0.0f, 1.0f
-   );
-
-   const float sin_pan = sin( camera.PanAngle );
-   const float cos_pan = cos( camera.PanAngle );
-   camera.PanningToCamera = cv::Matx33f(
-      cos_pan, 0.0f, -sin_pan,
-      0.0f, 1.0f, 0.0f,
-      sin_pan, 0.0f, cos_pan
-   );
-   const float sin_tilt = sin( camera.TiltAngle );
-   const float cos_tilt = cos( camera.TiltAngle );
-   camera.TiltingToCamera = cv::Matx33f(
-      1.0f, 0.0f, 0.0f,
-      0.0f, cos_tilt, -sin_tilt,
-      0.0f, sin_tilt, cos_tilt
-   );
-   camera.ToWorldCoordinate = camera.PanningToCamera.inv() * camera.TiltingToCamera.inv();
-
    const cv::Point camera_in_world = cv::Point(
       static_cast<int>(round( actual_position_in_meter.x * MeterToPixel )), 
       static_cast<int>(round( actual_position_in_meter.y * MeterToPixel ))
    );
-   for (const auto& zone : CustomizedZones) {
-      if (isInsideZone( camera_in_world, zone.Zone )) {
-         camera.Altitude = zone.Altitude;
-         break;
-      }
+   const int camera = LocalCameras.add(
+      camera_index,
+      width, height,
+      focal_length,
+      pan_angle_in_degree * static_cast<float>(CV_PI) / 180.0f,
+      tilt_angle_in_degree * static_cast<float>(CV_PI) / 180.0f,
+      camera_height_in_meter,
+      getAltitudeOnWorldMap( camera_in_world ),
+      cv::Point3f(actual_position_in_meter.y, 0.0f, actual_position_in_meter.x)
+   );
+   CameraViews.emplace_back( height, width, CV_8UC3, WHITE_COLOR );
+   {
+      std::lock_guard<std::mutex> lock( FloorMaskMutex );
+      FloorMasks.emplace_back();
    }
+   GroundSamplingMaps.emplace_back();
+   updateGroundSamplingMap( camera );
 
    renderCameraPositionOnWorldMap( camera );
-   LocalCameras.emplace_back( camera );
 }
 
 bool LocationDetection::transformCameraToWorld(
    cv::Point2f& transformed, 
    const cv::Point& camera_point,
    float altitude_of_point,
-   const Camera& camera
+   int camera
 ) const
 {
-   const auto half_width = static_cast<float>(camera.CameraView.cols) * 0.5f;
-   const auto half_height = static_cast<float>(camera.CameraView.rows) * 0.5f;
-   const float sin_tilt = sin( camera.TiltAngle );
-   const float cos_tilt = cos( camera.TiltAngle );
-   const float f_mul_sin_tilt = camera.FocalLength * sin_tilt;
+   const float half_width = LocalCameras.HalfWidths[camera];
+   const float half_height = LocalCameras.HalfHeights[camera];
+   const float cos_tilt = LocalCameras.CosTilts[camera];
+   const float f_mul_sin_tilt = LocalCameras.FocalLengths[camera] * LocalCameras.SinTilts[camera];
 
    cv::Point3f ground_point;
    ground_point.z = f_mul_sin_tilt + (static_cast<float>(camera_point.y) - half_height) * cos_tilt;
 
-   const float h = camera.CameraHeight + camera.Altitude - altitude_of_point;
+   const float h = LocalCameras.CameraHeights[camera] + LocalCameras.Altitudes[camera] - altitude_of_point;
    if (ground_point.z <= 0.0f || h < 0.0f) return false;
 
    ground_point.z = h / ground_point.z;
    ground_point.x = (static_cast<float>(camera_point.x) - half_width) * ground_point.z;
    ground_point.y = (static_cast<float>(camera_point.y) - half_height) * ground_point.z;
-   ground_point.z = camera.FocalLength * ground_point.z;
+   ground_point.z = LocalCameras.FocalLengths[camera] * ground_point.z;
 
-   const cv::Point3f world_point = camera.ToWorldCoordinate * ground_point + camera.Translation;
+   const cv::Point3f world_point = LocalCameras.ToWorldCoordinates[camera] * ground_point + LocalCameras.Translations[camera];
    const cv::Point2f image_point(world_point.z * MeterToPixel, world_point.x * MeterToPixel);
    transformed = image_point;
 
@@ -235,36 +347,18 @@ bool LocationDetection::transformCameraToWorld(
       0.0f <= image_point.y && image_point.y < static_cast<float>(FloorImage.rows);
 }
 
-bool LocationDetection::canSeePointOnDefaultAltitude(cv::Point2f& world_point, const cv::Point& camera_point, const Camera& camera)
-{
-   if (transformCameraToWorld( world_point, camera_point, DefaultAltitude, camera )) {
-      for (const auto& zone : CustomizedZones) {
-         if (isInsideZone( static_cast<cv::Point>(world_point), zone.Zone )) {
-            return false;            
-         }
-      }
-      return true;
-   }
-   return false;
-}
-
-bool LocationDetection::getValidWorldPointFromCamera(cv::Point2f& valid_world_point, const cv::Point& camera_point, const Camera& camera)
+bool LocationDetection::getValidWorldPointFromCamera(cv::Point2f& valid_world_point, const cv::Point& camera_point, int camera) const
+// the highest altitude level whose region contains the transformed point is visible from the camera.
 {
-   float max_altitude = canSeePointOnDefaultAltitude( valid_world_point, camera_point, camera ) ?
-         DefaultAltitude : -std::numeric_limits<float>::infinity();
-   
    cv::Point2f world_point;
-   for (const auto& zone : CustomizedZones) {
-      if (transformCameraToWorld( world_point, camera_point, zone.Altitude, camera )) {
-         if (isInsideZone( static_cast<cv::Point>(world_point), zone.Zone )) {
-            if (max_altitude < zone.Altitude) {
-               max_altitude = zone.Altitude;
-               valid_world_point = world_point;
-            }
-         }
+   for (const auto& altitude : Arrangement.getAltitudeLevels()) {
+      if (transformCameraToWorld( world_point, camera_point, altitude, camera ) &&
+          Arrangement.isOnLevel( static_cast<cv::Point>(world_point), altitude )) {
+         valid_world_point = world_point;
+         return true;
       }
    }
-   return !isinf( max_altitude );
+   return false;
 }
 
 cv::Vec3b LocationDetection::getPixelBilinearInterpolated(const cv::Point2f& image_point)
@@ -295,12 +389,13 @@ cv::Vec3b LocationDetection::getPixelBilinearInterpolated(const cv::Point2f& ima
    };
 }
 
-void LocationDetection::renderCameraView(Camera& camera)
+void LocationDetection::renderCameraView(int camera)
 {
    cv::Point2f valid_world_point;
-   for (int j = 0; j < camera.CameraView.rows; ++j) {
-      auto* view_ptr = camera.CameraView.ptr<cv::Vec3b>(j);
-      for (int i = 0; i < camera.CameraView.cols; ++i) {
+   cv::Mat& camera_view = CameraViews[camera];
+   for (int j = 0; j < camera_view.rows; ++j) {
+      auto* view_ptr = camera_view.ptr<cv::Vec3b>(j);
+      for (int i = 0; i < camera_view.cols; ++i) {
          const cv::Point camera_point(i, j);
          if (getValidWorldPointFromCamera( valid_world_point, camera_point, camera )) {
             view_ptr[i] = getPixelBilinearInterpolated( valid_world_point );
@@ -313,35 +408,49 @@ void LocationDetection::transformWorldToCamera(
    cv::Point& transformed, 
    const cv::Point& world_point,
    float altitude_of_point,
-   const Camera& camera
+   int camera
+) const
+{
+   cv::Point2f camera_point;
+   transformWorldToCamera( camera_point, static_cast<cv::Point2f>(world_point), altitude_of_point, camera );
+   transformed.x = static_cast<int>(round( camera_point.x ));
+   transformed.y = static_cast<int>(round( camera_point.y ));
+}
+
+void LocationDetection::transformWorldToCamera(
+   cv::Point2f& transformed,
+   const cv::Point2f& world_point,
+   float altitude_of_point,
+   int camera
 ) const
 // camera's view direction is z-axis, down direction is y-axis, and right direction is x-axis.
 {
-   const cv::Point2f actual_point_in_meter(
-      static_cast<float>(world_point.x) / MeterToPixel, 
-      static_cast<float>(world_point.y) / MeterToPixel
-   );
-   const float h = camera.CameraHeight + camera.Altitude - altitude_of_point;
-   cv::Point3f world = camera.Intrinsic * camera.TiltingToCamera * camera.PanningToCamera * cv::Point3f(
-      actual_point_in_meter.y - camera.Translation.x, 
+   const cv::Point2f actual_point_in_meter(world_point.x / MeterToPixel, world_point.y / MeterToPixel);
+   const float h = LocalCameras.CameraHeights[camera] + LocalCameras.Altitudes[camera] - altitude_of_point;
+   const cv::Point3f& translation = LocalCameras.Translations[camera];
+   cv::Point3f world = LocalCameras.ToImages[camera] * cv::Point3f(
+      actual_point_in_meter.y - translation.x, 
       h, 
-      actual_point_in_meter.x - camera.Translation.z
+      actual_point_in_meter.x - translation.z
    );
    if (world.z == 0.0f) world.z = 1e-7f;
-   world.x /= world.z;
-   world.y /= world.z;
-   transformed.x = static_cast<int>(round( world.x ));
-   transformed.y = static_cast<int>(round( world.y ));
+   transformed.x = world.x / world.z;
+   transformed.y = world.y / world.z;
 }
 
-void LocationDetection::renderZonesInCamera(Camera& camera)
+void LocationDetection::renderZonesInCamera(int camera)
 {
-   for (const auto& zone : CustomizedZones) {
-      std::vector<cv::Point> points_in_camera(zone.Zone.size());
-      for (uint i = 0; i < zone.Zone.size(); ++i) {
-         transformWorldToCamera( points_in_camera[i], zone.Zone[i], zone.Altitude, camera );
+   const ZoneScene& scene = Arrangement.getScene();
+   std::vector<cv::Point> points_in_camera;
+   for (int z = 0; z < scene.getZoneNum(); ++z) {
+      for (int r = scene.ZoneRingOffsets[z]; r < scene.ZoneRingOffsets[z + 1]; ++r) {
+         const int offset = scene.RingOffsets[r];
+         points_in_camera.resize( scene.RingOffsets[r + 1] - offset );
+         for (uint i = 0; i < points_in_camera.size(); ++i) {
+            transformWorldToCamera( points_in_camera[i], scene.Vertices[offset + i], scene.Altitudes[z], camera );
+         }
+         renderZone( CameraViews[camera], points_in_camera, YELLOW_COLOR );
       }
-      renderZone( camera.CameraView, points_in_camera, YELLOW_COLOR );
    }
 }
 
@@ -355,24 +464,15 @@ void LocationDetection::pickPointOnWorldMapCallback(int evt, int x, int y, int f
       const cv::Point2f actual_point_in_meter(static_cast<float>(x) / MeterToPixel, static_cast<float>(y) / MeterToPixel );
       std::cout << "\n>> Event Location Generated on World Map: " << actual_point_in_meter << " (in meter)\n";
 
-      float max_altitude = DefaultAltitude;
-      for (const auto& zone : CustomizedZones) {
-         if (isInsideZone( world_point, zone.Zone )) {
-            if (max_altitude < zone.Altitude) {
-               max_altitude = zone.Altitude;
-            }
-         }
-      }
+      std::vector<cv::Point> camera_points;
+      detectLocationInAllCameras( camera_points, actual_point_in_meter );
 
       std::cout << ">> Event Location Information in Each Camera:\n";
-      for (auto& camera : LocalCameras) {
-         cv::Point camera_point;
-         transformWorldToCamera( camera_point, world_point, max_altitude, camera );
-
-         cv::Mat camera_view = camera.CameraView.clone();
-         cv::circle( camera_view, camera_point, 5, RED_COLOR, -1 );
-         cv::imshow( "Camera#" + std::to_string( camera.Index ), camera_view );
-         std::cout << ">> \t- Camera#" << std::to_string( camera.Index ) << " " << camera_point << "\n";
+      for (int camera = 0; camera < LocalCameras.size(); ++camera) {
+         cv::Mat camera_view = CameraViews[camera].clone();
+         cv::circle( camera_view, camera_points[camera], 5, RED_COLOR, -1 );
+         cv::imshow( "Camera#" + std::to_string( LocalCameras.Indices[camera] ), camera_view );
+         std::cout << ">> \t- Camera#" << std::to_string( LocalCameras.Indices[camera] ) << " " << camera_points[camera] << "\n";
       }
       cv::imshow( "Event Generation", viewer );
    }
@@ -385,7 +485,7 @@ void LocationDetection::pickPointOnWorldMapCallbackWrapper(int evt, int x, int y
 
 void LocationDetection::generateEventOnWorldMap()
 {
-   for (auto& camera : LocalCameras) {
+   for (int camera = 0; camera < LocalCameras.size(); ++camera) {
       renderCameraView( camera );
       renderZonesInCamera( camera );
    }
@@ -402,13 +502,13 @@ void LocationDetection::generateEventOnWorldMap()
 void LocationDetection::pickPointOnCameraCallback(int evt, int x, int y, int flags, void* param)
 {
    if (evt == cv::EVENT_LBUTTONDOWN) {
-      auto* camera = static_cast<Camera*>(param);
-      cv::Mat viewer = camera->CameraView.clone();
+      const int camera = *static_cast<int*>(param);
+      cv::Mat viewer = CameraViews[camera].clone();
       
       cv::Point2f valid_world_point;
       const cv::Point camera_point(x, y);
-      if (getValidWorldPointFromCamera( valid_world_point, camera_point, *camera )) {
-         std::cout << "\n>> Event Location Generated on Camera#" << camera->Index << ": " << camera_point << "\n";
+      if (getValidWorldPointFromCamera( valid_world_point, camera_point, camera )) {
+         std::cout << "\n>> Event Location Generated on Camera#" << LocalCameras.Indices[camera] << ": " << camera_point << "\n";
          cv::circle( viewer, camera_point, 5, RED_COLOR, -1 );
 
          const cv::Point2f actual_point_in_meter( valid_world_point.x / MeterToPixel, valid_world_point.y / MeterToPixel );
@@ -420,7 +520,7 @@ void LocationDetection::pickPointOnCameraCallback(int evt, int x, int y, int fla
          cv::resizeWindow( "World Map", world_map.cols / 3, world_map.rows / 3 );
          cv::imshow( "World Map", world_map );
       }
-      cv::imshow( "Event Generation on Camera#" + std::to_string( camera->Index ), viewer );
+      cv::imshow( "Event Generation on Camera#" + std::to_string( LocalCameras.Indices[camera] ), viewer );
    }
 }
 
@@ -431,27 +531,21 @@ void LocationDetection::pickPointOnCameraCallbackWrapper(int evt, int x, int y,
 
 void LocationDetection::generateEventOnCamera(int camera_index)
 {
-   const auto camera = find_if( 
-      LocalCameras.begin(), LocalCameras.end(), 
-      [camera_index](const Camera& cam)
-      {
-         return cam.Index == camera_index;
-      }
-   );
-   if (camera == LocalCameras.end()) return;
+   int camera = LocalCameras.find( camera_index );
+   if (camera < 0) return;
 
-   renderCameraView( *camera );
-   renderZonesInCamera( *camera );
+   renderCameraView( camera );
+   renderZonesInCamera( camera );
    
-   cv::imshow( "Event Generation on Camera#" + std::to_string( camera->Index ), camera->CameraView );
-   cv::setMouseCallback( "Event Generation on Camera#" + std::to_string( camera->Index ), pickPointOnCameraCallbackWrapper, &*camera );
+   cv::imshow( "Event Generation on Camera#" + std::to_string( camera_index ), CameraViews[camera] );
+   cv::setMouseCallback( "Event Generation on Camera#" + std::to_string( camera_index ), pickPointOnCameraCallbackWrapper, &camera );
    cv::waitKey();
    cv::destroyAllWindows();
 }
 
 void LocationDetection::detectLocation(cv::Point& camera_point, int camera_index, const cv::Point2f& actual_position_in_meter)
 {
-   if (static_cast<int>(LocalCameras.size()) <= camera_index) {
+   if (LocalCameras.size() <= camera_index) {
       camera_point = { -1, -1 };
       return;
    }
@@ -460,26 +554,116 @@ void LocationDetection::detectLocation(cv::Point& camera_point, int camera_index
       static_cast<int>(round( actual_position_in_meter.x * MeterToPixel )), 
       static_cast<int>(round( actual_position_in_meter.y * MeterToPixel ))
    );
-
-   float altitude = DefaultAltitude;
-   for (const auto& zone : CustomizedZones) {
-      if (isInsideZone( world_point, zone.Zone )) {
-         altitude = zone.Altitude;
-         break;
-      }
-   }
-   transformWorldToCamera( camera_point, world_point, altitude, LocalCameras[camera_index] );
+   transformWorldToCamera( camera_point, world_point, getAltitudeOnWorldMap( world_point ), camera_index );
 }
 
 void LocationDetection::detectLocation(cv::Point2f& actual_position_in_meter, const cv::Point& camera_point, int camera_index)
 {
    actual_position_in_meter = { -1.0f, -1.0f };
-   if (static_cast<int>(LocalCameras.size()) <= camera_index) return;
+   if (LocalCameras.size() <= camera_index) return;
    
    cv::Point2f valid_world_point;
-   Camera& camera = LocalCameras[camera_index];
-   if (getValidWorldPointFromCamera( valid_world_point, camera_point, camera )) {
+   if (getValidWorldPointFromCamera( valid_world_point, camera_point, camera_index )) {
       actual_position_in_meter.x = valid_world_point.x / MeterToPixel;
       actual_position_in_meter.y = valid_world_point.y / MeterToPixel;
    }
+}
+
+void LocationDetection::detectLocationInAllCameras(
+   std::vector<cv::Point>& camera_points, 
+   const cv::Point2f& actual_position_in_meter
+) const
+// streams through the parameters of all cameras without touching their views.
+{
+   const cv::Point world_point(
+      static_cast<int>(round( actual_position_in_meter.x * MeterToPixel )), 
+      static_cast<int>(round( actual_position_in_meter.y * MeterToPixel ))
+   );
+   const float altitude = getAltitudeOnWorldMap( world_point );
+   camera_points.resize( LocalCameras.size() );
+   for (int camera = 0; camera < LocalCameras.size(); ++camera) {
+      transformWorldToCamera( camera_points[camera], world_point, altitude, camera );
+   }
+}
+
+void LocationDetection::detectLocation(LocalizedDetection& localized, const Detection& detection) const
+{
+   cv::Point2f valid_world_point;
+   localized.Source = detection;
+   localized.IsValid = 0 <= detection.CameraIndex && detection.CameraIndex < LocalCameras.size() &&
+      getValidWorldPointFromCamera( valid_world_point, static_cast<cv::Point>(detection.CameraPoint), detection.CameraIndex );
+   localized.ActualPositionInMeter = localized.IsValid ?
+      cv::Point2f(valid_world_point.x / MeterToPixel, valid_world_point.y / MeterToPixel) : cv::Point2f(-1.0f, -1.0f);
+   localized.ZoneIndex = localized.IsValid ? Arrangement.locate( static_cast<cv::Point>(valid_world_point) ) - 1 : -1;
+   localized.PositionCovariance = localized.IsValid ?
+      GroundSamplingMap::getCovariance( getGroundJacobian( detection.CameraPoint, valid_world_point, detection.CameraIndex ) ) :
+      cv::Vec3f(0.0f, 0.0f, 0.0f);
+}
+
+void LocationDetection::detectLocations(
+   std::vector<LocalizedDetection>& localized, 
+   const std::vector<Detection>& detections
+) const
+{
+   localized.resize( detections.size() );
+   for (size_t i = 0; i < detections.size(); ++i) detectLocation( localized[i], detections[i] );
+}
+
+int LocationDetection::getZoneIndex(const cv::Point2f& actual_position_in_meter) const
+{
+   const int region = Arrangement.locate( static_cast<cv::Point>(actual_position_in_meter * MeterToPixel) );
+   return region > 0 ? region - 1 : -1;
+}
+
+float LocationDetection::getMeterPerPixel(const LocalizedDetection& localized) const
+{
+   const int camera = localized.Source.CameraIndex;
+   if (!localized.IsValid || camera < 0 || camera >= LocalCameras.size()) return std::numeric_limits<float>::infinity();
+   return GroundSamplingMap::getMeterPerPixel(
+      getGroundJacobian( localized.Source.CameraPoint, localized.ActualPositionInMeter * MeterToPixel, camera )
+   );
+}
+
+void LocationDetection::getPerspectiveScaleMap(
+   PerspectiveScaleMap& scale_map,
+   int camera_index,
+   float person_height_in_meter,
+   int cell_size
+) const
+// the foot at the center of each cell is localized, and the head above it is projected back to the camera.
+{
+   scale_map.CellSize = std::max( cell_size, 1 );
+   scale_map.PersonHeight = person_height_in_meter;
+   if (camera_index < 0 || camera_index >= LocalCameras.size()) {
+      scale_map.PixelHeights.release();
+      return;
+   }
+
+   const int width = LocalCameras.Widths[camera_index];
+   const int height = LocalCameras.Heights[camera_index];
+   scale_map.PixelHeights = cv::Mat::zeros(
+      (height + scale_map.CellSize - 1) / scale_map.CellSize,
+      (width + scale_map.CellSize - 1) / scale_map.CellSize,
+      CV_32FC1
+   );
+   cv::Point2f world_point, foot, head;
+   for (int y = 0; y < scale_map.PixelHeights.rows; ++y) {
+      auto* row = scale_map.PixelHeights.ptr<float>(y);
+      for (int x = 0; x < scale_map.PixelHeights.cols; ++x) {
+         const cv::Point center(
+            std::min( x * scale_map.CellSize + scale_map.CellSize / 2, width - 1 ),
+            std::min( y * scale_map.CellSize + scale_map.CellSize / 2, height - 1 )
+         );
+         if (!getValidWorldPointFromCamera( world_point, center, camera_index )) continue;
+
+         const float altitude = getAltitudeOnWorldMap( static_cast<cv::Point>(world_point) );
+         if (LocalCameras.CameraHeights[camera_index] + LocalCameras.Altitudes[camera_index] <= altitude + person_height_in_meter) {
+            continue; // the head would be above the camera
+         }
+         // projected in float, since rounding both ends would be a large error for a person of a few pixels.
+         transformWorldToCamera( foot, world_point, altitude, camera_index );
+         transformWorldToCamera( head, world_point, altitude + person_height_in_meter, camera_index );
+         row[x] = static_cast<float>(cv::norm( foot - head ));
+      }
+   }
 }
\ No newline at end of file
@@ -14,8 +14,15 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <mutex>
 
 #include "ProjectPath.h"
+#include "ZoneArrangement.h"
+#include "CameraStore.h"
+#include "RunLengthMask.h"
+#include "PerspectiveScaleMap.h"
+#include "GroundSamplingMap.h"
+#include "Detection.h"
 
 using uchar = unsigned char;
 using uint = unsigned int;
@@ -27,45 +34,20 @@ const cv::Scalar YELLOW_COLOR(0, 255, 255);
 const cv::Scalar WHITE_COLOR(255, 255, 255);
 const cv::Scalar BLACK_COLOR(0, 0, 0);
 
-struct CustomizedZone
-{
-   float Altitude;
-   std::vector<cv::Point> Zone;
-
-   CustomizedZone() : Altitude( 0.0f ) {}
-   CustomizedZone(float altitude, std::vector<cv::Point> zone) : Altitude( altitude ), Zone( std::move( zone ) ) {}
-};
-
 class LocationDetection
 {
 public:
-   struct Camera
-   {
-      int Index;
-      float FocalLength;
-      float PanAngle;
-      float TiltAngle;
-      float CameraHeight;
-      float Altitude;
-      cv::Mat CameraView;
-      cv::Matx33f Intrinsic;
-      cv::Matx33f PanningToCamera;
-      cv::Matx33f TiltingToCamera;
-      cv::Matx33f ToWorldCoordinate;
-      cv::Point3f Translation;
-
-      Camera() : Index( 0 ), FocalLength( 0.0f ), PanAngle( 0.0f ), TiltAngle( 0.0f ), 
-      CameraHeight( 0.0f ), Altitude( 0.0f ) {}
-   };
-
    LocationDetection(
       float actual_width, 
       float actual_height, 
-      const std::vector<CustomizedZone>& zones = std::vector<CustomizedZone>()
+      const std::vector<CustomizedZone>& zones = std::vector<CustomizedZone>(),
+      float zone_tolerance_in_meter = 0.0f,
+      bool customize_zones_if_empty = true
    );
    ~LocationDetection() = default;
 
    void customizeZones();
+   void setZoneTolerance(float zone_tolerance_in_meter);
    void setCamera(
       int camera_index,
       int width, 
@@ -79,8 +61,37 @@ public:
    void generateEventOnWorldMap();
    void generateEventOnCamera(int camera_index);
    
+   int getCameraNum() const { return LocalCameras.size(); }
+   const CameraStore& getCameras() const { return LocalCameras; }
+   float getMeterToPixel() const { return MeterToPixel; }
+   cv::Size2f getActualFloorSize() const { return cv::Size2f(ActualFloorWidth, ActualFloorHeight); }
+   const cv::Mat& getFloorImage() const { return FloorImage; }
+   const ZoneScene& getZoneScene() const { return Arrangement.getScene(); }
+   uint64_t getZoneVersion() const { return ZoneVersion; } // increased whenever the zones are rebuilt
+   int getZoneNum() const { return Arrangement.getScene().getZoneNum(); }
+   int getZoneIndex(const cv::Point2f& actual_position_in_meter) const;
+
    void detectLocation(cv::Point& camera_point, int camera_index, const cv::Point2f& actual_position_in_meter);
    void detectLocation(cv::Point2f& actual_position_in_meter, const cv::Point& camera_point, int camera_index);
+   void detectLocationInAllCameras(std::vector<cv::Point>& camera_points, const cv::Point2f& actual_position_in_meter) const;
+   void detectLocation(LocalizedDetection& localized, const Detection& detection) const;
+   void detectLocations(std::vector<LocalizedDetection>& localized, const std::vector<Detection>& detections) const;
+   float getMeterPerPixel(const LocalizedDetection& localized) const; // from the ground sampling map of its camera
+   // built on the first call after the camera is set or the zones change, so the modes which never ask for it
+   // do not pay for localizing every pixel of every camera. it is empty if the camera index is not valid.
+   RunLengthMask getValidFloorMask(int camera_index) const;
+   // it shares the raster, which is replaced rather than modified when the zones change. empty if the index is not valid.
+   GroundSamplingMap getGroundSamplingMap(int camera_index) const
+   {
+      if (camera_index < 0 || camera_index >= LocalCameras.size()) return {};
+      return GroundSamplingMaps[camera_index];
+   }
+   void getPerspectiveScaleMap(
+      PerspectiveScaleMap& scale_map,
+      int camera_index,
+      float person_height_in_meter = 1.7f,
+      int cell_size = 16
+   ) const;
    
 private:
    inline static LocationDetection* Instance = nullptr;
@@ -92,33 +103,58 @@ private:
    float ActualFloorHeight; // ActualFloorHeight(m) * MeterToPixel(pixel/m) = FloorImage.rows(pixel)
    float MeterToPixel;
    float DefaultAltitude;
-   std::vector<CustomizedZone> CustomizedZones;
-   std::vector<Camera> LocalCameras;
+   float ZoneTolerance; // zones are simplified within this distance in meter before registered
+   std::vector<CustomizedZone> CustomizedZones; // zones as given, which are only for display
+   std::vector<CustomizedZone> SimplifiedZones;
+   ZoneArrangement Arrangement;
+   uint64_t ZoneVersion;
+   CameraStore LocalCameras;
+   std::vector<cv::Mat> CameraViews; // rendered view of each camera in LocalCameras
+   mutable std::mutex FloorMaskMutex;
+   mutable std::vector<RunLengthMask> FloorMasks; // of each camera in LocalCameras, whose size is 0 until built
+   std::vector<GroundSamplingMap> GroundSamplingMaps; // of each camera in LocalCameras
 
    void renderZone(cv::Mat& image, const std::vector<cv::Point>& zone, const cv::Scalar& color = YELLOW_COLOR) const;
+
+   void simplifyZone(std::vector<cv::Point>& simplified, const std::vector<cv::Point>& zone) const;
+   void updateZoneArrangement();
+   void updateFloorMask(int camera) const;
+   void updateGroundSamplingMap(int camera);
+   bool differentiateCameraToWorld(
+      cv::Vec4f& jacobian,
+      const cv::Point& camera_point,
+      const cv::Point2f& world_point,
+      int camera
+   ) const;
+   cv::Vec4f getGroundJacobian(const cv::Point2f& camera_point, const cv::Point2f& world_point, int camera) const;
    
-   bool isInsideZone(const cv::Point& point, const std::vector<cv::Point>& zone) const;
-   
-   void renderCameraPositionOnWorldMap(const Camera& camera);
+   float getAltitudeOnWorldMap(const cv::Point& world_point) const;
+
+   void renderCameraPositionOnWorldMap(int camera);
 
    bool transformCameraToWorld(
       cv::Point2f& transformed, 
       const cv::Point& camera_point,
       float altitude_of_point,
-      const Camera& camera
+      int camera
    ) const;
-   bool canSeePointOnDefaultAltitude(cv::Point2f& world_point, const cv::Point& camera_point, const Camera& camera);
-   bool getValidWorldPointFromCamera(cv::Point2f& valid_world_point, const cv::Point& camera_point, const Camera& camera);
+   bool getValidWorldPointFromCamera(cv::Point2f& valid_world_point, const cv::Point& camera_point, int camera) const;
    cv::Vec3b getPixelBilinearInterpolated(const cv::Point2f& image_point);
-   void renderCameraView(Camera& camera);
+   void renderCameraView(int camera);
 
    void transformWorldToCamera(
       cv::Point& transformed, 
       const cv::Point& world_point, 
       float altitude_of_point,
-      const Camera& camera
+      int camera
+   ) const;
+   void transformWorldToCamera(
+      cv::Point2f& transformed,
+      const cv::Point2f& world_point,
+      float altitude_of_point,
+      int camera
    ) const;
-   void renderZonesInCamera(Camera& camera);
+   void renderZonesInCamera(int camera);
 
    bool isEndPoint(int x, int y);
    void customizeZonesCallback(int evt, int x, int y, int flags, void* param);
@@ -0,0 +1,69 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+bool MappedFile::open(const std::string& path)
+{
+   close();
+#ifdef _WIN32
+   HANDLE file = CreateFileA( path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+   if (file == INVALID_HANDLE_VALUE) return false;
+
+   LARGE_INTEGER file_size;
+   if (!GetFileSizeEx( file, &file_size )) {
+      CloseHandle( file );
+      return false;
+   }
+   Size = static_cast<size_t>(file_size.QuadPart);
+   if (Size > 0) {
+      HANDLE mapping = CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+      if (mapping != nullptr) {
+         Data = static_cast<const char*>(MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 ));
+         CloseHandle( mapping );
+      }
+   }
+   CloseHandle( file );
+#else
+   const int file = ::open( path.c_str(), O_RDONLY );
+   if (file < 0) return false;
+
+   struct stat file_status{};
+   if (fstat( file, &file_status ) != 0) {
+      ::close( file );
+      return false;
+   }
+   Size = static_cast<size_t>(file_status.st_size);
+   if (Size > 0) {
+      void* mapped = mmap( nullptr, Size, PROT_READ, MAP_PRIVATE, file, 0 );
+      if (mapped != MAP_FAILED) {
+         madvise( mapped, Size, MADV_SEQUENTIAL );
+         Data = static_cast<const char*>(mapped);
+      }
+   }
+   ::close( file );
+#endif
+   Opened = Size == 0 || Data != nullptr;
+   if (!Opened) Size = 0;
+   return Opened;
+}
+
+void MappedFile::close()
+{
+   if (Data != nullptr) {
+#ifdef _WIN32
+      UnmapViewOfFile( Data );
+#else
+      munmap( const_cast<char*>(Data), Size );
+#endif
+   }
+   Data = nullptr;
+   Size = 0;
+   Opened = false;
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+/*
+ * Author: Emoy Kim
+ * E-mail: emoy.kim_AT_gmail.com
+ *
+ * This code is a free software; it can be freely used, changed and redistributed.
+ * If you use any version of the code, please reference the code.
+ *
+ */
+
+#pragma once
+
+#include <string>
+
+// Read-only memory mapping of a whole file.
+class MappedFile
+{
+public:
+   MappedFile() : Data( nullptr ), Size( 0 ), Opened( false ) {}
+   ~MappedFile() { close(); }
+   MappedFile(const MappedFile&) = delete;
+   MappedFile& operator=(const MappedFile&) = delete;
+
+   bool open(const std::string& path);
+   void close();
+   const char* data() const { return Data; }
+   size_t size() const { return Size; }
+   bool isOpen() const { return Opened; }
+
+private:
+   const char* Data;
+   size_t Size;
+   bool Opened;
+};
\ No newline at end of file
@@ -0,0 +1,180 @@
+#include "MultiTargetTracker.h"
+
+MultiTargetTracker::MultiTargetTracker(
+   float gate_in_meter,
+   float acceleration_noise,
+   float measurement_noise,
+   int confirmation_hit_num,
+   int max_miss_num,
+   float pixel_noise
+) : Gate( gate_in_meter ), AccelerationVariance( acceleration_noise * acceleration_noise ),
+   MeasurementVariance( measurement_noise * measurement_noise ), PixelVariance( pixel_noise * pixel_noise ),
+   ConfirmationHitNum( confirmation_hit_num ), MaxMissNum( max_miss_num ), NextId( 0 ),
+   LastTimestamp( std::numeric_limits<double>::quiet_NaN() )
+{
+}
+
+void MultiTargetTracker::predict(float dt)
+// discrete white noise acceleration model, whose process noise is q * [dt^3/3, dt^2/2; dt^2/2, dt].
+{
+   const float q00 = AccelerationVariance * dt * dt * dt / 3.0f;
+   const float q01 = AccelerationVariance * dt * dt * 0.5f;
+   const float q11 = AccelerationVariance * dt;
+   const size_t track_num = Ids.size();
+   for (size_t i = 0; i < track_num; ++i) {
+      Xs[i] += VelocityXs[i] * dt;
+      Ys[i] += VelocityYs[i] * dt;
+   }
+   for (size_t i = 0; i < track_num; ++i) {
+      const float p01 = Covariances[i] + dt * VelocityVariances[i];
+      PositionVariances[i] += dt * (Covariances[i] + p01) + q00;
+      Covariances[i] = p01 + q01;
+      VelocityVariances[i] += q11;
+   }
+}
+
+void MultiTargetTracker::buildDetectionGrid(const std::vector<LocalizedDetection>& detections)
+{
+   DetectionIndices.clear();
+   for (size_t i = 0; i < detections.size(); ++i) {
+      if (detections[i].IsValid) DetectionIndices.emplace_back( static_cast<int>(i) );
+   }
+
+   DetectionGrid.reset( Gate, DetectionIndices.size() );
+   MeasurementVariances.resize( detections.size() );
+   for (const auto& d : DetectionIndices) {
+      DetectionGrid.insert( d, detections[d].ActualPositionInMeter );
+      MeasurementVariances[d] = getMeasurementVariance( detections[d] );
+   }
+}
+
+float MultiTargetTracker::getMeasurementVariance(const LocalizedDetection& detection) const
+// the covariance of the detection is isotropic here, so the mean of its variances of x and y is taken.
+{
+   const cv::Vec3f& covariance = detection.PositionCovariance;
+   return MeasurementVariance + PixelVariance * 0.5f * (covariance[0] + covariance[2]);
+}
+
+void MultiTargetTracker::gate(const std::vector<LocalizedDetection>& detections)
+// the cost is the squared Mahalanobis distance, which should be also within the gate in meter.
+{
+   const float squared_gate = Gate * Gate;
+   Candidates.clear();
+   for (int t = 0; t < static_cast<int>(Ids.size()); ++t) {
+      const cv::Point2f position(Xs[t], Ys[t]);
+      DetectionGrid.forEachNeighbor(
+         position,
+         [&](int d)
+         {
+            const cv::Point2f difference = detections[d].ActualPositionInMeter - position;
+            const float squared_distance = difference.dot( difference );
+            if (squared_distance > squared_gate) return;
+
+            const float cost = squared_distance / (PositionVariances[t] + MeasurementVariances[d]);
+            if (cost < ChiSquareGate) Candidates.push_back( { cost, t, d } );
+         }
+      );
+   }
+}
+
+void MultiTargetTracker::assign(int detection_num)
+// leaving a track unassigned costs as much as the gate, so an assignment is chosen whenever it is gated.
+{
+   Assignment.solve( AssignedDetections, static_cast<int>(Ids.size()), detection_num, Candidates, ChiSquareGate );
+   IsDetectionAssigned.assign( detection_num, 0 );
+   for (const auto& d : AssignedDetections) {
+      if (d >= 0) IsDetectionAssigned[d] = 1;
+   }
+}
+
+void MultiTargetTracker::correct(int track, const cv::Point2f& measurement, float measurement_variance)
+{
+   const float innovation_variance = PositionVariances[track] + measurement_variance;
+   const float position_gain = PositionVariances[track] / innovation_variance;
+   const float velocity_gain = Covariances[track] / innovation_variance;
+   const float dx = measurement.x - Xs[track];
+   const float dy = measurement.y - Ys[track];
+   Xs[track] += position_gain * dx;
+   Ys[track] += position_gain * dy;
+   VelocityXs[track] += velocity_gain * dx;
+   VelocityYs[track] += velocity_gain * dy;
+   VelocityVariances[track] -= velocity_gain * Covariances[track];
+   PositionVariances[track] *= 1.0f - position_gain;
+   Covariances[track] *= 1.0f - position_gain;
+   HitNums[track]++;
+   MissNums[track] = 0;
+}
+
+void MultiTargetTracker::addTrack(const cv::Point2f& position, float measurement_variance)
+// the velocity is unknown at first, so its variance is as large as walking speed allows.
+{
+   constexpr float max_speed = 3.0f;
+   Ids.emplace_back( NextId++ );
+   Xs.emplace_back( position.x );
+   Ys.emplace_back( position.y );
+   VelocityXs.emplace_back( 0.0f );
+   VelocityYs.emplace_back( 0.0f );
+   PositionVariances.emplace_back( measurement_variance );
+   Covariances.emplace_back( 0.0f );
+   VelocityVariances.emplace_back( max_speed * max_speed );
+   HitNums.emplace_back( 1 );
+   MissNums.emplace_back( 0 );
+}
+
+void MultiTargetTracker::removeTrack(int track)
+// the last track fills the hole, so the order of tracks is not kept.
+{
+   const auto last = static_cast<int>(Ids.size()) - 1;
+   const auto remove = [track, last](auto& values)
+   {
+      values[track] = values[last];
+      values.pop_back();
+   };
+   remove( Ids );
+   remove( Xs );
+   remove( Ys );
+   remove( VelocityXs );
+   remove( VelocityYs );
+   remove( PositionVariances );
+   remove( Covariances );
+   remove( VelocityVariances );
+   remove( HitNums );
+   remove( MissNums );
+}
+
+void MultiTargetTracker::update(const std::vector<LocalizedDetection>& detections, double timestamp)
+{
+   if (!std::isnan( LastTimestamp ) && timestamp > LastTimestamp) {
+      predict( static_cast<float>(timestamp - LastTimestamp) );
+   }
+   if (std::isnan( LastTimestamp ) || timestamp > LastTimestamp) LastTimestamp = timestamp;
+
+   buildDetectionGrid( detections );
+   gate( detections );
+   assign( static_cast<int>(detections.size()) );
+
+   const auto track_num = static_cast<int>(Ids.size());
+   for (int t = 0; t < track_num; ++t) {
+      const int d = AssignedDetections[t];
+      if (d >= 0) correct( t, detections[d].ActualPositionInMeter, MeasurementVariances[d] );
+      else MissNums[t]++;
+   }
+   // a tentative track is removed at its first miss.
+   for (int t = track_num - 1; t >= 0; --t) {
+      if (MissNums[t] > MaxMissNum || (MissNums[t] > 0 && HitNums[t] < ConfirmationHitNum)) removeTrack( t );
+   }
+   for (const auto& d : DetectionIndices) {
+      if (!IsDetectionAssigned[d]) addTrack( detections[d].ActualPositionInMeter, MeasurementVariances[d] );
+   }
+}
+
+void MultiTargetTracker::getTracks(std::vector<Track>& tracks, bool confirmed_only) const
+{
+   tracks.clear();
+   for (size_t i = 0; i < Ids.size(); ++i) {
+      if (confirmed_only && HitNums[i] < ConfirmationHitNum) continue;
+      tracks.push_back(
+         { Ids[i], cv::Point2f(Xs[i], Ys[i]), cv::Point2f(VelocityXs[i], VelocityYs[i]), HitNums[i], MissNums[i] }
+      );
+   }
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+/*
+ * Author: Emoy Kim
+ * E-mail: emoy.kim_AT_gmail.com
+ *
+ * This code is a free software; it can be freely used, changed and redistributed.
+ * If you use any version of the code, please reference the code.
+ *
+ */
+
+#pragma once
+
+#include "LocationDetection.h"
+#include "SparseAssignment.h"
+#include "SpatialHashGrid.h"
+
+struct Track
+{
+   int Id;
+   cv::Point2f PositionInMeter;
+   cv::Point2f VelocityInMeter; // per second
+   int HitNum;
+   int MissNum; // consecutive frames without a detection
+};
+
+// Tracks targets on the world map with a constant-velocity Kalman filter per target.
+// The states are kept in structure-of-arrays so that the prediction and the update of all tracks are plain loops.
+// x and y are filtered independently with the same noises, so one 2x2 covariance (position, velocity) serves both.
+// The measurement noise of a detection grows with the ground sampling distance of its camera at the detection,
+// so a far detection pulls its track less than a near one.
+// Detections are gated by a grid whose cell is as large as the gate, and only the tracks and the detections
+// in neighboring cells become candidate pairs of the sparse assignment.
+class MultiTargetTracker
+{
+public:
+   explicit MultiTargetTracker(
+      float gate_in_meter = 1.0f,
+      float acceleration_noise = 2.0f,    // standard deviation in m/s^2
+      float measurement_noise = 0.15f,    // standard deviation in meter
+      int confirmation_hit_num = 3,
+      int max_miss_num = 15,
+      float pixel_noise = 1.0f            // standard deviation in pixel of the camera point of a detection
+   );
+   ~MultiTargetTracker() = default;
+
+   // the detections of one frame at the timestamp, and invalid ones are ignored.
+   void update(const std::vector<LocalizedDetection>& detections, double timestamp);
+   void getTracks(std::vector<Track>& tracks, bool confirmed_only = true) const;
+   size_t getTrackNum() const { return Ids.size(); }
+
+private:
+   static constexpr float ChiSquareGate = 9.21f; // 99% of 2 degrees of freedom
+
+   float Gate;
+   float AccelerationVariance;
+   float MeasurementVariance;
+   float PixelVariance;
+   int ConfirmationHitNum;
+   int MaxMissNum;
+   int NextId;
+   double LastTimestamp;
+
+   std::vector<int> Ids;
+   std::vector<float> Xs;
+   std::vector<float> Ys;
+   std::vector<float> VelocityXs;
+   std::vector<float> VelocityYs;
+   std::vector<float> PositionVariances;
+   std::vector<float> Covariances;       // between position and velocity
+   std::vector<float> VelocityVariances;
+   std::vector<int> HitNums;
+   std::vector<int> MissNums;
+
+   // buffers reused across frames
+   std::vector<int> DetectionIndices;    // valid detections
+   SpatialHashGrid DetectionGrid;
+   std::vector<float> MeasurementVariances; // of each detection
+   std::vector<AssignmentEdge> Candidates; // the row is a track and the column is a detection
+   SparseAssignment Assignment;
+   std::vector<int> AssignedDetections;  // of each track, or -1
+   std::vector<uchar> IsDetectionAssigned;
+
+   void predict(float dt);
+   void buildDetectionGrid(const std::vector<LocalizedDetection>& detections);
+   float getMeasurementVariance(const LocalizedDetection& detection) const;
+   void gate(const std::vector<LocalizedDetection>& detections);
+   void assign(int detection_num);
+   void correct(int track, const cv::Point2f& measurement, float measurement_variance);
+   void addTrack(const cv::Point2f& position, float measurement_variance);
+   void removeTrack(int track);
+};
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include "OriginDestinationMatrix.h"
+
+OriginDestinationMatrix::OriginDestinationMatrix(int zone_num, double bucket_duration, int bucket_num, double max_transit_time) :
+   ZoneNum( zone_num ), BucketDuration( bucket_duration ), MaxTransitTime( max_transit_time ), LatestBucketIndex( -1 ),
+   LastPruneTime( -std::numeric_limits<double>::infinity() ), Buckets( std::max( bucket_num, 1 ) )
+{
+   for (auto& bucket : Buckets) bucket.Index = -1;
+}
+
+void OriginDestinationMatrix::removeStaleExits(double timestamp)
+{
+   for (auto it = LastExits.begin(); it != LastExits.end();) {
+      if (timestamp - it->second.Timestamp > MaxTransitTime) it = LastExits.erase( it );
+      else ++it;
+   }
+}
+
+void OriginDestinationMatrix::pruneExits(double timestamp)
+// the exits are scanned once per max_transit_time, so they are kept at most twice as long whatever the events are.
+{
+   if (timestamp - LastPruneTime <= MaxTransitTime) return;
+   removeStaleExits( timestamp );
+   LastPruneTime = timestamp;
+}
+
+void OriginDestinationMatrix::add(const GeofenceEvent& event)
+{
+   pruneExits( event.Timestamp );
+   if (event.Type == GeofenceEventType::Exit) {
+      LastExits[event.TrackId] = { event.ZoneIndex, event.Timestamp };
+      return;
+   }
+   if (event.Type != GeofenceEventType::Enter) return;
+
+   const auto it = LastExits.find( event.TrackId );
+   if (it == LastExits.end()) return;
+
+   if (it->second.ZoneIndex != event.ZoneIndex && event.Timestamp - it->second.Timestamp <= MaxTransitTime) {
+      addTransition( it->second.ZoneIndex, event.ZoneIndex, event.Timestamp );
+   }
+   LastExits.erase( it );
+}
+
+void OriginDestinationMatrix::addTransition(int origin_zone, int destination_zone, double timestamp)
+{
+   if (origin_zone < 0 || destination_zone < 0 || origin_zone >= ZoneNum || destination_zone >= ZoneNum) return;
+
+   const auto index = static_cast<int64_t>(floor( timestamp / BucketDuration ));
+   if (index > LatestBucketIndex) LatestBucketIndex = index;
+   if (index < 0 || index <= LatestBucketIndex - static_cast<int64_t>(Buckets.size())) return; // out of the ring
+
+   Bucket& bucket = Buckets[static_cast<size_t>(index % static_cast<int64_t>(Buckets.size()))];
+   std::unique_lock<std::shared_mutex> lock( Mutex );
+   if (bucket.Index != index) {
+      bucket.Index = index;
+      bucket.Counts.clear();
+   }
+   bucket.Counts[static_cast<uint32_t>(origin_zone * ZoneNum + destination_zone)]++;
+}
+
+void OriginDestinationMatrix::query(cv::Mat& counts, double begin_time, double end_time) const
+{
+   counts = cv::Mat::zeros( ZoneNum, ZoneNum, CV_32SC1 );
+   const auto first = static_cast<int64_t>(floor( begin_time / BucketDuration ));
+   const auto last = static_cast<int64_t>(floor( end_time / BucketDuration ));
+
+   std::shared_lock<std::shared_mutex> lock( Mutex );
+   for (const auto& bucket : Buckets) {
+      if (bucket.Index < first || bucket.Index > last) continue;
+
+      for (const auto& count : bucket.Counts) {
+         counts.at<int>(static_cast<int>(count.first) / ZoneNum, static_cast<int>(count.first) % ZoneNum) += static_cast<int>(count.second);
+      }
+   }
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+/*
+ * Author: Emoy Kim
+ * E-mail: emoy.kim_AT_gmail.com
+ *
+ * This code is a free software; it can be freely used, changed and redistributed.
+ * If you use any version of the code, please reference the code.
+ *
+ */
+
+#pragma once
+
+#include <unordered_map>
+#include <shared_mutex>
+
+#include "GeofenceEngine.h"
+
+// Counts of tracks moving from one zone to another over a sliding window.
+// A transition is counted when a track enters a zone within max_transit_time after it exits another zone.
+// Counts are kept in a ring of time buckets, and each bucket has only the zone pairs which occurred in it,
+// so a query sums the buckets in the window instead of scanning the events again.
+// The window is as long as bucket_duration * bucket_num at most, and a query is rounded to whole buckets.
+// One thread adds events while other threads query, and a query blocks the adding thread only while it sums.
+class OriginDestinationMatrix
+{
+public:
+   OriginDestinationMatrix(int zone_num, double bucket_duration = 60.0, int bucket_num = 1440, double max_transit_time = 600.0);
+   ~OriginDestinationMatrix() = default;
+
+   void add(const GeofenceEvent& event);
+   void addTransition(int origin_zone, int destination_zone, double timestamp);
+
+   // counts.at<int>(origin, destination) is the number of transitions in [begin_time, end_time].
+   void query(cv::Mat& counts, double begin_time, double end_time) const;
+
+private:
+   struct Bucket
+   {
+      int64_t Index; // floor(time / BucketDuration), or -1 if empty
+      std::unordered_map<uint32_t, uint32_t> Counts; // origin * ZoneNum + destination
+   };
+
+   struct ZoneExit
+   {
+      int ZoneIndex;
+      double Timestamp;
+   };
+
+   int ZoneNum;
+   double BucketDuration;
+   double MaxTransitTime;
+   int64_t LatestBucketIndex;
+   double LastPruneTime; // when the stale exits were removed last
+   std::vector<Bucket> Buckets;
+   std::unordered_map<int, ZoneExit> LastExits; // of each track, used only by the adding thread
+   mutable std::shared_mutex Mutex;
+
+   void removeStaleExits(double timestamp);
+   void pruneExits(double timestamp);
+};
\ No newline at end of file
@@ -0,0 +1,28 @@
+#include "PerspectiveScaleMap.h"
+
+float PerspectiveScaleMap::getPixelHeight(const cv::Point2f& foot_point) const
+{
+   const auto x = static_cast<int>(foot_point.x) / CellSize;
+   const auto y = static_cast<int>(foot_point.y) / CellSize;
+   if (foot_point.x < 0.0f || foot_point.y < 0.0f || x >= PixelHeights.cols || y >= PixelHeights.rows) return 0.0f;
+   return PixelHeights.at<float>(y, x);
+}
+
+bool PerspectiveScaleMap::getPixelHeightRange(float& min_height, float& max_height, const cv::Rect& region) const
+{
+   const int x0 = std::max( region.x / CellSize, 0 );
+   const int y0 = std::max( region.y / CellSize, 0 );
+   const int x1 = std::min( (region.x + region.width - 1) / CellSize, PixelHeights.cols - 1 );
+   const int y1 = std::min( (region.y + region.height - 1) / CellSize, PixelHeights.rows - 1 );
+   min_height = std::numeric_limits<float>::max();
+   max_height = 0.0f;
+   for (int y = y0; y <= y1; ++y) {
+      const auto* row = PixelHeights.ptr<float>(y);
+      for (int x = x0; x <= x1; ++x) {
+         if (row[x] <= 0.0f) continue;
+         min_height = std::min( min_height, row[x] );
+         max_height = std::max( max_height, row[x] );
+      }
+   }
+   return max_height > 0.0f;
+}
\ No newline at end of file
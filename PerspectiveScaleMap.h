@@ -0,0 +1,28 @@
+/*
+ * Author: Emoy Kim
+ * E-mail: emoy.kim_AT_gmail.com
+ *
+ * This code is a free software; it can be freely used, changed and redistributed.
+ * If you use any version of the code, please reference the code.
+ *
+ */
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+// Expected height in pixels of a standing person whose foot is at each cell of a camera, which is 0 where the foot
+// cannot be on the world map. A detector can search only the scales around it in each region.
+struct PerspectiveScaleMap
+{
+   int CellSize;             // in pixels of the camera
+   float PersonHeight;       // in meter
+   cv::Mat PixelHeights;     // CV_32FC1, one element per cell
+
+   PerspectiveScaleMap() : CellSize( 16 ), PersonHeight( 1.7f ) {}
+
+   float getPixelHeight(const cv::Point2f& foot_point) const;
+
+   // the range of nonzero heights of the cells which the region overlaps, and false if there is none.
+   bool getPixelHeightRange(float& min_height, float& max_height, const cv::Rect& region) const;
+};
\ No newline at end of file
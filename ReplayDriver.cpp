@@ -0,0 +1,123 @@
+#include "ReplayDriver.h"
+
+void LatencyHistogram::add(int64_t nanoseconds, uint64_t count)
+{
+   const auto value = static_cast<uint64_t>(std::max( nanoseconds, static_cast<int64_t>(0) ));
+   int bucket = 0;
+   if (value >= SubBucketNum) {
+      int msb = 63;
+      while ((value >> msb) == 0) --msb;
+      const int shift = msb - SubBucketBits;
+      bucket = (shift + 1) * SubBucketNum + static_cast<int>((value >> shift) & (SubBucketNum - 1));
+   }
+   else bucket = static_cast<int>(value);
+   Counts[bucket] += count;
+   Total += count;
+}
+
+double LatencyHistogram::getPercentile(double percent) const
+{
+   if (Total == 0) return 0.0;
+
+   const auto rank = static_cast<uint64_t>(std::ceil( percent / 100.0 * static_cast<double>(Total) ));
+   uint64_t accumulated = 0;
+   for (size_t bucket = 0; bucket < Counts.size(); ++bucket) {
+      accumulated += Counts[bucket];
+      if (accumulated >= std::max( rank, static_cast<uint64_t>(1) )) {
+         if (bucket < SubBucketNum) return static_cast<double>(bucket);
+
+         // the middle of the bucket
+         const int shift = static_cast<int>(bucket / SubBucketNum) - 1;
+         const auto lower = static_cast<double>((SubBucketNum + bucket % SubBucketNum) << shift);
+         return lower + static_cast<double>(static_cast<uint64_t>(1) << shift) * 0.5;
+      }
+   }
+   return 0.0;
+}
+
+ReplayDriver::ReplayDriver(const LocationDetection& location_detector, size_t batch_size) :
+   LocationDetector( location_detector ), BatchSize( std::max( batch_size, static_cast<size_t>(1) ) )
+{
+}
+
+bool ReplayDriver::replay(const std::string& log_path, double speed, const std::string& output_path)
+{
+   using clock = std::chrono::steady_clock;
+
+   EventLogReader input;
+   if (!input.open( log_path )) {
+      std::cerr << "Cannot Open " << log_path << "...\n";
+      return false;
+   }
+   EventLogWriter output;
+   if (!output_path.empty() && !output.open( output_path )) {
+      std::cerr << "Cannot Open " << output_path << "...\n";
+      return false;
+   }
+
+   const bool honors_time = speed > 0.0;
+   const auto start = clock::now();
+   double first_timestamp = 0.0;
+   bool is_first = true;
+   LatencyHistogram latencies;
+   std::vector<Detection> batch;
+   std::vector<clock::time_point> releases;
+   std::vector<LocalizedDetection> localized;
+   batch.reserve( BatchSize );
+   releases.reserve( BatchSize );
+
+   const auto convertBatch = [&]()
+   {
+      if (batch.empty()) return;
+
+      LocationDetector.detectLocations( localized, batch );
+      const auto done = clock::now();
+      for (const auto& release : releases) {
+         latencies.add( std::chrono::duration_cast<std::chrono::nanoseconds>(done - release).count() );
+      }
+      if (output.isOpen()) {
+         for (const auto& result : localized) output.write( result );
+      }
+      batch.clear();
+      releases.clear();
+   };
+
+   for (size_t c = 0; c < input.getChunkNum(); ++c) {
+      const EventChunk chunk = input.getChunk( c );
+      for (size_t i = 0; i < chunk.Size; ++i) {
+         if (is_first) {
+            first_timestamp = chunk.Timestamps[i];
+            is_first = false;
+         }
+
+         auto release = clock::now();
+         if (honors_time) {
+            const double offset = std::max( chunk.Timestamps[i] - first_timestamp, 0.0 ) / speed;
+            release = start + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(offset));
+
+            // the records released until now are converted together, and then it waits for the next one.
+            if (release > clock::now()) {
+               convertBatch();
+               std::this_thread::sleep_until( release );
+            }
+         }
+         batch.emplace_back( chunk.getDetection( i ) );
+         releases.emplace_back( release );
+         if (batch.size() == BatchSize) convertBatch();
+      }
+   }
+   convertBatch();
+   if (output.isOpen()) output.close();
+
+   const double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+   const uint64_t total = latencies.getTotal();
+   std::cout << ">> Replayed " << total << " records in " << elapsed << " s at "
+      << (honors_time ? std::to_string( speed ) + "x" : std::string("full speed")) << ": "
+      << static_cast<size_t>(elapsed > 0.0 ? static_cast<double>(total) / elapsed : 0.0) << " records/s\n";
+   std::cout << ">> Latency (us): p50 " << latencies.getPercentile( 50.0 ) * 1e-3
+      << ", p90 " << latencies.getPercentile( 90.0 ) * 1e-3
+      << ", p99 " << latencies.getPercentile( 99.0 ) * 1e-3
+      << ", p99.9 " << latencies.getPercentile( 99.9 ) * 1e-3
+      << ", max " << latencies.getPercentile( 100.0 ) * 1e-3 << "\n";
+   return true;
+}
\ No newline at end of file
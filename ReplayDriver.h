@@ -0,0 +1,54 @@
+/*
+ * Author: Emoy Kim
+ * E-mail: emoy.kim_AT_gmail.com
+ *
+ * This code is a free software; it can be freely used, changed and redistributed.
+ * If you use any version of the code, please reference the code.
+ *
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <thread>
+
+#include "LocationDetection.h"
+#include "EventLog.h"
+
+// Histogram of latencies in nanoseconds with 32 linear sub-buckets for each power of two,
+// so a percentile is within about 3% of the exact one while the memory is fixed.
+class LatencyHistogram
+{
+public:
+   LatencyHistogram() : Counts{}, Total( 0 ) {}
+   ~LatencyHistogram() = default;
+
+   void add(int64_t nanoseconds, uint64_t count = 1);
+   double getPercentile(double percent) const; // in nanoseconds
+   uint64_t getTotal() const { return Total; }
+
+private:
+   static constexpr int SubBucketBits = 5;
+   static constexpr int SubBucketNum = 1 << SubBucketBits;
+
+   std::array<uint64_t, 64 * SubBucketNum> Counts;
+   uint64_t Total;
+};
+
+// Replays recorded detections in an event log through LocationDetection::detectLocations(), as the live ingest does.
+// Records are released at their recorded times scaled by the speed multiplier, or as fast as possible if it is 0.
+// The latency of a record is from its release to the end of the conversion of its batch.
+class ReplayDriver
+{
+public:
+   explicit ReplayDriver(const LocationDetection& location_detector, size_t batch_size = 1024);
+   ~ReplayDriver() = default;
+
+   // the localized detections are written to output_path if it is not empty.
+   bool replay(const std::string& log_path, double speed, const std::string& output_path = std::string());
+
+private:
+   const LocationDetection& LocationDetector;
+   size_t BatchSize;
+};
\ No newline at end of file
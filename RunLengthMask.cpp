@@ -0,0 +1,85 @@
+#include "RunLengthMask.h"
+
+void RunLengthMask::clear(const cv::Size& size)
+{
+   Size = size;
+   RowOffsets.assign( 1, 0 );
+   Spans.clear();
+}
+
+int RunLengthMask::getArea() const
+{
+   int area = 0;
+   for (const auto& span : Spans) area += span.End - span.Begin;
+   return area;
+}
+
+cv::Rect RunLengthMask::getBoundingRect() const
+{
+   int min_x = Size.width, max_x = 0, min_y = Size.height, max_y = 0;
+   for (int y = 0; y + 1 < static_cast<int>(RowOffsets.size()); ++y) {
+      if (RowOffsets[y] == RowOffsets[y + 1]) continue;
+
+      min_y = std::min( min_y, y );
+      max_y = y + 1;
+      min_x = std::min( min_x, Spans[RowOffsets[y]].Begin );
+      max_x = std::max( max_x, Spans[RowOffsets[y + 1] - 1].End );
+   }
+   return min_y < max_y ? cv::Rect(min_x, min_y, max_x - min_x, max_y - min_y) : cv::Rect();
+}
+
+void RunLengthMask::render(cv::Mat& mask) const
+{
+   mask = cv::Mat::zeros( Size, CV_8UC1 );
+   for (int y = 0; y + 1 < static_cast<int>(RowOffsets.size()); ++y) {
+      auto* row = mask.ptr<uchar>(y);
+      for (int s = RowOffsets[y]; s < RowOffsets[y + 1]; ++s) {
+         std::fill( row + Spans[s].Begin, row + Spans[s].End, static_cast<uchar>(255) );
+      }
+   }
+}
+
+void RunLengthMask::resize(RunLengthMask& resized, const cv::Size& size) const
+// each row takes the nearest row of this mask, and the spans are scaled and merged if they touch after rounding.
+{
+   resized.clear( size );
+   if (Size.width <= 0 || Size.height <= 0) {
+      for (int y = 0; y < size.height; ++y) resized.endRow();
+      return;
+   }
+
+   const double scale_x = static_cast<double>(size.width) / Size.width;
+   const double scale_y = static_cast<double>(Size.height) / size.height;
+   for (int y = 0; y < size.height; ++y) {
+      const int source_y = std::min( static_cast<int>((y + 0.5) * scale_y), Size.height - 1 );
+      const auto row_begin = static_cast<int>(resized.Spans.size());
+      for (int s = RowOffsets[source_y]; s < RowOffsets[source_y + 1]; ++s) {
+         const auto begin = static_cast<int>(round( Spans[s].Begin * scale_x ));
+         const auto end = std::min( static_cast<int>(round( Spans[s].End * scale_x )), size.width );
+         if (begin >= end) continue;
+
+         if (static_cast<int>(resized.Spans.size()) > row_begin && resized.Spans.back().End >= begin) {
+            resized.Spans.back().End = std::max( resized.Spans.back().End, end );
+         }
+         else resized.addSpan( begin, end );
+      }
+      resized.endRow();
+   }
+}
+
+void RunLengthMask::apply(cv::Mat& image, const cv::Rect& roi) const
+{
+   const auto pixel_size = static_cast<int>(image.elemSize());
+   for (int y = 0; y < image.rows; ++y) {
+      uchar* row = image.ptr<uchar>(y);
+      const int mask_y = y + roi.y;
+      int x = 0; // in the roi
+      for (int s = RowOffsets[mask_y]; s < RowOffsets[mask_y + 1]; ++s) {
+         const int begin = std::min( std::max( Spans[s].Begin - roi.x, 0 ), image.cols );
+         const int end = std::min( std::max( Spans[s].End - roi.x, 0 ), image.cols );
+         if (begin > x) std::fill( row + x * pixel_size, row + begin * pixel_size, static_cast<uchar>(0) );
+         x = std::max( x, end );
+      }
+      if (x < image.cols) std::fill( row + x * pixel_size, row + image.cols * pixel_size, static_cast<uchar>(0) );
+   }
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+/*
+ * Author: Emoy Kim
+ * E-mail: emoy.kim_AT_gmail.com
+ *
+ * This code is a free software; it can be freely used, changed and redistributed.
+ * If you use any version of the code, please reference the code.
+ *
+ */
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+struct RowSpan
+{
+   int Begin;
+   int End; // exclusive
+};
+
+// A binary mask as the spans of set pixels in each row. The spans of the y-th row are
+// Spans[RowOffsets[y]] ~ Spans[RowOffsets[y + 1] - 1] from left to right, so a row is skipped or processed
+// span by span without testing each pixel.
+struct RunLengthMask
+{
+   cv::Size Size;
+   std::vector<int> RowOffsets;
+   std::vector<RowSpan> Spans;
+
+   // a mask is built by adding the spans of each row from the top, and ending each row.
+   void clear(const cv::Size& size);
+   void addSpan(int begin, int end) { Spans.push_back( { begin, end } ); }
+   void endRow() { RowOffsets.emplace_back( static_cast<int>(Spans.size()) ); }
+
+   bool empty() const { return Spans.empty(); }
+   int getArea() const;
+   cv::Rect getBoundingRect() const;
+   void render(cv::Mat& mask) const; // CV_8UC1, 255 on the spans
+   void resize(RunLengthMask& resized, const cv::Size& size) const;
+
+   // sets 0 to the pixels of the image outside the spans, where the image is the roi of the masked one.
+   void apply(cv::Mat& image, const cv::Rect& roi) const;
+};
\ No newline at end of file
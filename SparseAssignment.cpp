@@ -0,0 +1,147 @@
+#include "SparseAssignment.h"
+
+void SparseAssignment::buildRows(int row_num, const std::vector<AssignmentEdge>& edges, float unassigned_cost)
+// the benefit of an edge is how much it saves against leaving the row unassigned, so a dummy column benefits 0.
+{
+   RowOffsets.assign( row_num + 1, 0 );
+   for (const auto& edge : edges) {
+      if (edge.Cost < unassigned_cost) RowOffsets[edge.Row + 1]++;
+   }
+   for (int i = 0; i < row_num; ++i) RowOffsets[i + 1] += RowOffsets[i];
+
+   Columns.resize( RowOffsets[row_num] );
+   Benefits.resize( RowOffsets[row_num] );
+   UnassignedRows.assign( RowOffsets.begin(), RowOffsets.end() - 1 ); // used as the next slot of each row
+   for (const auto& edge : edges) {
+      if (edge.Cost >= unassigned_cost) continue;
+      const int slot = UnassignedRows[edge.Row]++;
+      Columns[slot] = edge.Column;
+      Benefits[slot] = unassigned_cost - edge.Cost;
+   }
+}
+
+void SparseAssignment::auction(std::vector<int>& row_to_column, int row_num, float epsilon)
+// each unassigned row bids for its best column, raising the price by the margin to its second best plus epsilon.
+{
+   UnassignedRows.clear();
+   for (int i = row_num - 1; i >= 0; --i) UnassignedRows.emplace_back( i );
+   std::fill( Owners.begin(), Owners.end(), -1 );
+   std::fill( row_to_column.begin(), row_to_column.end(), -1 );
+
+   while (!UnassignedRows.empty()) {
+      const int row = UnassignedRows.back();
+      UnassignedRows.pop_back();
+
+      int best_column = -1;
+      float best_value = 0.0f; // the dummy column
+      float second_value = -std::numeric_limits<float>::infinity();
+      for (int e = RowOffsets[row]; e < RowOffsets[row + 1]; ++e) {
+         const float value = Benefits[e] - Prices[Columns[e]];
+         if (value > best_value) {
+            second_value = best_value;
+            best_value = value;
+            best_column = Columns[e];
+         }
+         else if (value > second_value) second_value = value;
+      }
+      if (best_column < 0) continue; // stays on its dummy column
+
+      Prices[best_column] += best_value - second_value + epsilon;
+      const int previous_owner = Owners[best_column];
+      if (previous_owner >= 0) {
+         row_to_column[previous_owner] = -1;
+         UnassignedRows.emplace_back( previous_owner );
+      }
+      Owners[best_column] = row;
+      row_to_column[row] = best_column;
+   }
+}
+
+void SparseAssignment::solve(
+   std::vector<int>& row_to_column,
+   int row_num,
+   int column_num,
+   const std::vector<AssignmentEdge>& edges,
+   float unassigned_cost
+)
+{
+   row_to_column.assign( row_num, -1 );
+   if (row_num == 0 || column_num == 0 || edges.empty()) return;
+
+   buildRows( row_num, edges, unassigned_cost );
+   Prices.assign( column_num, 0.0f );
+   Owners.assign( column_num, -1 );
+
+   // all prices start from 0 and a column never gets unassigned once bid for, so the columns left unassigned are
+   // at the lowest price and the result is within row_num * epsilon of the optimum.
+   // epsilon scaling is not used because it breaks this condition when rows may stay unassigned.
+   auction( row_to_column, row_num, MinEpsilon );
+}
+
+bool checkSparseAssignment(int instance_num, int size)
+{
+   size = std::clamp( size, 1, 10 );
+   constexpr float epsilon = 1e-3f;
+   std::mt19937 generator(0);
+   std::uniform_real_distribution<float> cost(0.0f, 10.0f);
+   std::bernoulli_distribution is_edge(0.5);
+
+   SparseAssignment assignment(epsilon);
+   std::vector<int> row_to_column;
+   std::vector<AssignmentEdge> edges;
+   std::vector<std::vector<float>> costs(size, std::vector<float>(size));
+   int failure_num = 0;
+   for (int n = 0; n < instance_num; ++n) {
+      const float unassigned_cost = cost( generator );
+      edges.clear();
+      for (int i = 0; i < size; ++i) {
+         for (int j = 0; j < size; ++j) {
+            costs[i][j] = is_edge( generator ) ? cost( generator ) : std::numeric_limits<float>::infinity();
+            if (std::isfinite( costs[i][j] )) edges.push_back( { costs[i][j], i, j } );
+         }
+      }
+      assignment.solve( row_to_column, size, size, edges, unassigned_cost );
+
+      bool is_valid = true;
+      float total = 0.0f;
+      std::vector<bool> is_used(size, false);
+      for (int i = 0; i < size; ++i) {
+         const int j = row_to_column[i];
+         if (j < 0) total += unassigned_cost;
+         else if (is_used[j] || !std::isfinite( costs[i][j] )) is_valid = false;
+         else {
+            is_used[j] = true;
+            total += costs[i][j];
+         }
+      }
+
+      // each row takes an unused column of its edges or stays unassigned.
+      float optimum = std::numeric_limits<float>::infinity();
+      std::fill( is_used.begin(), is_used.end(), false );
+      const std::function<void(int, float)> search = [&](int row, float sum)
+      {
+         if (sum >= optimum) return;
+         if (row == size) {
+            optimum = sum;
+            return;
+         }
+         search( row + 1, sum + unassigned_cost );
+         for (int j = 0; j < size; ++j) {
+            if (is_used[j] || !std::isfinite( costs[row][j] )) continue;
+            is_used[j] = true;
+            search( row + 1, sum + costs[row][j] );
+            is_used[j] = false;
+         }
+      };
+      search( 0, 0.0f );
+
+      if (!is_valid || total > optimum + static_cast<float>(size) * epsilon + 1e-4f) {
+         std::cerr << "Instance " << n << ": the cost " << total << " is not optimal, which should be " << optimum
+            << (is_valid ? "\n" : " (invalid assignment)\n");
+         failure_num++;
+      }
+   }
+   std::cout << instance_num - failure_num << " / " << instance_num << " instances of " << size << "x" << size
+      << " are within " << static_cast<float>(size) * epsilon << " of the optimum\n";
+   return failure_num == 0;
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+/*
+ * Author: Emoy Kim
+ * E-mail: emoy.kim_AT_gmail.com
+ *
+ * This code is a free software; it can be freely used, changed and redistributed.
+ * If you use any version of the code, please reference the code.
+ *
+ */
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <functional>
+#include <iostream>
+
+struct AssignmentEdge
+{
+   float Cost;
+   int Row;
+   int Column;
+};
+
+// Minimum cost assignment on a sparse cost matrix by the forward auction algorithm.
+// Only the given edges can be assigned, and each row may stay unassigned at unassigned_cost, so an edge costing more
+// than that is never chosen. Each row has its own dummy column for it, whose price never rises.
+// The work grows with the number of edges rather than rows * columns, and the buffers are reused across calls.
+class SparseAssignment
+{
+public:
+   explicit SparseAssignment(float epsilon = 1e-3f) : MinEpsilon( epsilon ) {}
+   ~SparseAssignment() = default;
+
+   // row_to_column[i] is the column assigned to the i-th row, or -1 if it is not assigned.
+   void solve(
+      std::vector<int>& row_to_column,
+      int row_num,
+      int column_num,
+      const std::vector<AssignmentEdge>& edges,
+      float unassigned_cost
+   );
+
+private:
+   float MinEpsilon;
+   std::vector<int> RowOffsets; // edges of the i-th row are in [RowOffsets[i], RowOffsets[i + 1])
+   std::vector<int> Columns;
+   std::vector<float> Benefits;
+   std::vector<float> Prices;
+   std::vector<int> Owners;     // row of each column, or -1
+   std::vector<int> UnassignedRows;
+
+   void buildRows(int row_num, const std::vector<AssignmentEdge>& edges, float unassigned_cost);
+   void auction(std::vector<int>& row_to_column, int row_num, float epsilon);
+};
+
+// solves random sparse instances of size x size, where about half of the pairs are edges, and compares the costs with
+// the optimum found by brute force. the size is at most 10 to keep the brute force short.
+bool checkSparseAssignment(int instance_num, int size);
\ No newline at end of file
@@ -0,0 +1,21 @@
+#include "SpatialHashGrid.h"
+
+void SpatialHashGrid::reset(float cell_size, size_t expected_num)
+{
+   CellSize = cell_size;
+   size_t bucket_num = 64;
+   while (bucket_num < expected_num * 2) bucket_num <<= 1;
+   BucketHeads.assign( bucket_num, -1 );
+}
+
+void SpatialHashGrid::insert(int item, const cv::Point2f& position)
+{
+   if (item >= static_cast<int>(NextItems.size())) {
+      NextItems.resize( item + 1 );
+      Cells.resize( item + 1 );
+   }
+   Cells[item] = getCell( position );
+   const uint32_t bucket = getBucket( Cells[item].x, Cells[item].y );
+   NextItems[item] = BucketHeads[bucket];
+   BucketHeads[bucket] = item;
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+/*
+ * Author: Emoy Kim
+ * E-mail: emoy.kim_AT_gmail.com
+ *
+ * This code is a free software; it can be freely used, changed and redistributed.
+ * If you use any version of the code, please reference the code.
+ *
+ */
+
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+// Hash grid of items on the world map whose cell is as large as the search radius, so the items near a position
+// are in the nine cells around it. The items are indices in [0, item number), and each bucket is a chain of them.
+// Neighboring cells can share a bucket, so each item remembers its cell and is visited only from that cell.
+class SpatialHashGrid
+{
+public:
+   SpatialHashGrid() : CellSize( 1.0f ) {}
+   ~SpatialHashGrid() = default;
+
+   // the table has at least twice as many buckets as the expected items, so that the chains stay short.
+   void reset(float cell_size, size_t expected_num);
+   void insert(int item, const cv::Point2f& position);
+
+   // visits each item in the nine cells around the position once.
+   template<typename Visitor>
+   void forEachNeighbor(const cv::Point2f& position, Visitor&& visit) const
+   {
+      const cv::Point cell = getCell( position );
+      for (int y = cell.y - 1; y <= cell.y + 1; ++y) {
+         for (int x = cell.x - 1; x <= cell.x + 1; ++x) {
+            for (int i = BucketHeads[getBucket( x, y )]; i >= 0; i = NextItems[i]) {
+               if (Cells[i].x == x && Cells[i].y == y) visit( i );
+            }
+         }
+      }
+   }
+
+private:
+   float CellSize;
+   std::vector<int> BucketHeads; // the last item of each bucket, and -1 if empty
+   std::vector<int> NextItems;
+   std::vector<cv::Point> Cells; // of each item
+
+   cv::Point getCell(const cv::Point2f& position) const
+   {
+      return { static_cast<int>(floor( position.x / CellSize )), static_cast<int>(floor( position.y / CellSize )) };
+   }
+   uint32_t getBucket(int cell_x, int cell_y) const
+   {
+      const auto hash = static_cast<uint32_t>(cell_x) * 73856093u ^ static_cast<uint32_t>(cell_y) * 19349663u;
+      return hash & static_cast<uint32_t>(BucketHeads.size() - 1);
+   }
+};
\ No newline at end of file
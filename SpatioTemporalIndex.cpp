@@ -0,0 +1,341 @@
+#include "SpatioTemporalIndex.h"
+
+namespace
+{
+   constexpr char SpatioTemporalIndexMagic[8] = { 'L', 'D', 'S', 'T', 'I', 'D', 'X', '\0' };
+   constexpr uint32_t SpatioTemporalIndexVersion = 1;
+   constexpr uint32_t HilbertOrder = 16; // cells on each side are 2^16
+
+   size_t alignTo8(size_t size) { return (size + 7) & ~static_cast<size_t>(7); }
+
+   constexpr size_t PositionRecordSize = sizeof( double ) + sizeof( int32_t ) + 2 * sizeof( float );
+
+   size_t getBlockSize(size_t record_num) { return alignTo8( record_num * PositionRecordSize ); }
+
+   template<typename T>
+   void writeColumn(std::ofstream& file, const std::vector<T>& column)
+   {
+      file.write( reinterpret_cast<const char*>(column.data()), static_cast<std::streamsize>(column.size() * sizeof( T )) );
+   }
+
+   uint32_t getHilbertKey(uint32_t x, uint32_t y)
+   {
+      constexpr uint32_t n = 1u << HilbertOrder;
+      uint32_t key = 0;
+      for (uint32_t s = n >> 1; s > 0; s >>= 1) {
+         const uint32_t rx = (x & s) != 0 ? 1 : 0;
+         const uint32_t ry = (y & s) != 0 ? 1 : 0;
+         key += s * s * ((3 * rx) ^ ry);
+         if (ry == 0) {
+            if (rx == 1) {
+               x = n - 1 - x;
+               y = n - 1 - y;
+            }
+            std::swap( x, y );
+         }
+      }
+      return key;
+   }
+
+   uint32_t getCell(float coordinate, float cell_size)
+   {
+      const float cell = floor( coordinate / cell_size );
+      return static_cast<uint32_t>(std::min( std::max( cell, 0.0f ), static_cast<float>((1u << HilbertOrder) - 1) ));
+   }
+
+   bool isInsidePolygon(const cv::Point2f& point, const std::vector<cv::Point2f>& polygon)
+   {
+      bool is_inside = false;
+      for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+         if ((polygon[i].y > point.y) != (polygon[j].y > point.y) &&
+             point.x < polygon[j].x + (point.y - polygon[j].y) * (polygon[i].x - polygon[j].x) / (polygon[i].y - polygon[j].y)) {
+            is_inside = !is_inside;
+         }
+      }
+      return is_inside;
+   }
+}
+
+SpatioTemporalIndexWriter::SpatioTemporalIndexWriter(double chunk_duration, float cell_size_in_meter, size_t block_capacity) :
+   ChunkDuration( chunk_duration ), CellSize( cell_size_in_meter ),
+   BlockCapacity( static_cast<uint32_t>(std::max( block_capacity, static_cast<size_t>(1) )) ), RecordNum( 0 ),
+   ChunkEnd( -std::numeric_limits<double>::infinity() )
+{
+}
+
+bool SpatioTemporalIndexWriter::open(const std::string& path)
+{
+   close();
+   File.open( path, std::ios::binary | std::ios::trunc );
+   if (!File.is_open()) return false;
+
+   RecordNum = 0;
+   ChunkEnd = -std::numeric_limits<double>::infinity();
+   ChunkIndex.clear();
+   BlockIndex.clear();
+   const SpatioTemporalIndexHeader header{};
+   File.write( reinterpret_cast<const char*>(&header), sizeof( header ) );
+   File.write( "\0\0\0\0\0\0\0\0", static_cast<std::streamsize>(alignTo8( sizeof( header ) ) - sizeof( header )) );
+   return File.good();
+}
+
+void SpatioTemporalIndexWriter::write(const PositionRecord& record)
+{
+   if (record.Timestamp >= ChunkEnd) {
+      flushChunk();
+      ChunkEnd = (floor( record.Timestamp / ChunkDuration ) + 1.0) * ChunkDuration;
+   }
+   Records.emplace_back( record );
+}
+
+void SpatioTemporalIndexWriter::write(const LocalizedDetection& localized)
+{
+   if (localized.IsValid) {
+      write( PositionRecord{ localized.Source.Timestamp, localized.Source.CameraIndex, localized.ActualPositionInMeter } );
+   }
+}
+
+void SpatioTemporalIndexWriter::flushBlock(size_t begin, size_t end)
+{
+   SpatioTemporalBlockInfo info{};
+   info.Offset = static_cast<uint64_t>(File.tellp());
+   info.RecordNum = end - begin;
+   info.MinTimestamp = std::numeric_limits<double>::infinity();
+   info.MaxTimestamp = -std::numeric_limits<double>::infinity();
+   info.MinX = info.MinY = std::numeric_limits<float>::infinity();
+   info.MaxX = info.MaxY = -std::numeric_limits<float>::infinity();
+
+   Timestamps.clear();
+   Ids.clear();
+   Xs.clear();
+   Ys.clear();
+   for (size_t i = begin; i < end; ++i) {
+      const PositionRecord& record = Records[SortKeys[i].second];
+      Timestamps.emplace_back( record.Timestamp );
+      Ids.emplace_back( record.Id );
+      Xs.emplace_back( record.PositionInMeter.x );
+      Ys.emplace_back( record.PositionInMeter.y );
+      info.MinTimestamp = std::min( info.MinTimestamp, record.Timestamp );
+      info.MaxTimestamp = std::max( info.MaxTimestamp, record.Timestamp );
+      info.MinX = std::min( info.MinX, record.PositionInMeter.x );
+      info.MinY = std::min( info.MinY, record.PositionInMeter.y );
+      info.MaxX = std::max( info.MaxX, record.PositionInMeter.x );
+      info.MaxY = std::max( info.MaxY, record.PositionInMeter.y );
+   }
+   BlockIndex.emplace_back( info );
+
+   writeColumn( File, Timestamps );
+   writeColumn( File, Ids );
+   writeColumn( File, Xs );
+   writeColumn( File, Ys );
+   const size_t written = static_cast<size_t>(File.tellp()) - static_cast<size_t>(info.Offset);
+   File.write( "\0\0\0\0\0\0\0\0", static_cast<std::streamsize>(getBlockSize( info.RecordNum ) - written) );
+}
+
+void SpatioTemporalIndexWriter::flushChunk()
+// records are sorted by the Hilbert key and then by time, so the records of a block are close in space.
+{
+   if (Records.empty()) return;
+
+   SortKeys.clear();
+   for (size_t i = 0; i < Records.size(); ++i) {
+      const cv::Point2f& position = Records[i].PositionInMeter;
+      SortKeys.emplace_back( getHilbertKey( getCell( position.x, CellSize ), getCell( position.y, CellSize ) ), static_cast<uint32_t>(i) );
+   }
+   std::sort(
+      SortKeys.begin(), SortKeys.end(),
+      [this](const std::pair<uint32_t, uint32_t>& a, const std::pair<uint32_t, uint32_t>& b)
+      {
+         if (a.first != b.first) return a.first < b.first;
+         return Records[a.second].Timestamp < Records[b.second].Timestamp;
+      }
+   );
+
+   SpatioTemporalChunkInfo chunk{};
+   chunk.FirstBlock = BlockIndex.size();
+   for (size_t begin = 0; begin < SortKeys.size(); begin += BlockCapacity) {
+      flushBlock( begin, std::min( begin + BlockCapacity, SortKeys.size() ) );
+   }
+   chunk.BlockNum = BlockIndex.size() - chunk.FirstBlock;
+   chunk.MinTimestamp = std::numeric_limits<double>::infinity();
+   chunk.MaxTimestamp = -std::numeric_limits<double>::infinity();
+   for (size_t b = chunk.FirstBlock; b < BlockIndex.size(); ++b) {
+      chunk.MinTimestamp = std::min( chunk.MinTimestamp, BlockIndex[b].MinTimestamp );
+      chunk.MaxTimestamp = std::max( chunk.MaxTimestamp, BlockIndex[b].MaxTimestamp );
+   }
+   ChunkIndex.emplace_back( chunk );
+   RecordNum += Records.size();
+   Records.clear();
+}
+
+bool SpatioTemporalIndexWriter::close()
+{
+   if (!File.is_open()) return false;
+
+   flushChunk();
+   SpatioTemporalIndexHeader header{};
+   std::copy( SpatioTemporalIndexMagic, SpatioTemporalIndexMagic + sizeof( header.Magic ), header.Magic );
+   header.Version = SpatioTemporalIndexVersion;
+   header.BlockCapacity = BlockCapacity;
+   header.ChunkDuration = ChunkDuration;
+   header.CellSize = CellSize;
+   header.RecordNum = RecordNum;
+   header.ChunkNum = ChunkIndex.size();
+   header.BlockNum = BlockIndex.size();
+   header.ChunkIndexOffset = static_cast<uint64_t>(File.tellp());
+   writeColumn( File, ChunkIndex );
+   header.BlockIndexOffset = static_cast<uint64_t>(File.tellp());
+   writeColumn( File, BlockIndex );
+   File.seekp( 0 );
+   File.write( reinterpret_cast<const char*>(&header), sizeof( header ) );
+
+   const bool succeeded = File.good();
+   File.close();
+   return succeeded;
+}
+
+bool SpatioTemporalIndexReader::open(const std::string& path)
+{
+   ChunkIndex = ColumnSpan<SpatioTemporalChunkInfo>();
+   BlockIndex = ColumnSpan<SpatioTemporalBlockInfo>();
+   if (!File.open( path ) || File.size() < sizeof( SpatioTemporalIndexHeader )) return false;
+
+   std::copy( File.data(), File.data() + sizeof( Header ), reinterpret_cast<char*>(&Header) );
+   if (!std::equal( SpatioTemporalIndexMagic, SpatioTemporalIndexMagic + sizeof( Header.Magic ), Header.Magic ) ||
+       Header.Version != SpatioTemporalIndexVersion ||
+       Header.ChunkIndexOffset % 8 != 0 || Header.BlockIndexOffset % 8 != 0 ||
+       Header.ChunkIndexOffset > Header.BlockIndexOffset || Header.BlockIndexOffset > File.size() ||
+       Header.ChunkNum > (Header.BlockIndexOffset - Header.ChunkIndexOffset) / sizeof( SpatioTemporalChunkInfo ) ||
+       Header.BlockNum > (File.size() - Header.BlockIndexOffset) / sizeof( SpatioTemporalBlockInfo )) {
+      File.close();
+      return false;
+   }
+
+   ChunkIndex = ColumnSpan<SpatioTemporalChunkInfo>(
+      reinterpret_cast<const SpatioTemporalChunkInfo*>(File.data() + Header.ChunkIndexOffset), static_cast<size_t>(Header.ChunkNum)
+   );
+   BlockIndex = ColumnSpan<SpatioTemporalBlockInfo>(
+      reinterpret_cast<const SpatioTemporalBlockInfo*>(File.data() + Header.BlockIndexOffset), static_cast<size_t>(Header.BlockNum)
+   );
+   bool is_valid = true;
+   for (const auto& chunk : ChunkIndex) {
+      if (chunk.FirstBlock > Header.BlockNum || chunk.BlockNum > Header.BlockNum - chunk.FirstBlock) is_valid = false;
+   }
+   for (const auto& block : BlockIndex) {
+      if (block.Offset % 8 != 0 || block.Offset > Header.ChunkIndexOffset ||
+          block.RecordNum > (Header.ChunkIndexOffset - block.Offset) / PositionRecordSize ||
+          block.Offset + getBlockSize( static_cast<size_t>(block.RecordNum) ) > Header.ChunkIndexOffset) {
+         is_valid = false;
+      }
+   }
+   if (!is_valid) {
+      File.close();
+      ChunkIndex = ColumnSpan<SpatioTemporalChunkInfo>();
+      BlockIndex = ColumnSpan<SpatioTemporalBlockInfo>();
+   }
+   return is_valid;
+}
+
+template<typename Predicate>
+void SpatioTemporalIndexReader::scan(
+   std::vector<PositionRecord>& results,
+   const cv::Rect2f& bounds,
+   double begin_time,
+   double end_time,
+   Predicate is_inside
+) const
+// only the blocks whose time ranges and bounding boxes overlap the query are touched in the mapped file.
+{
+   ReadBlockNum = 0;
+   for (const auto& chunk : ChunkIndex) {
+      if (chunk.MaxTimestamp < begin_time || chunk.MinTimestamp > end_time) continue;
+
+      for (uint64_t b = chunk.FirstBlock; b < chunk.FirstBlock + chunk.BlockNum; ++b) {
+         const SpatioTemporalBlockInfo& block = BlockIndex[static_cast<size_t>(b)];
+         if (block.MaxTimestamp < begin_time || block.MinTimestamp > end_time ||
+             block.MaxX < bounds.x || block.MinX > bounds.x + bounds.width ||
+             block.MaxY < bounds.y || block.MinY > bounds.y + bounds.height) continue;
+
+         ReadBlockNum++;
+         const auto n = static_cast<size_t>(block.RecordNum);
+         const char* ptr = File.data() + block.Offset;
+         const auto* timestamps = reinterpret_cast<const double*>(ptr);
+         const auto* ids = reinterpret_cast<const int32_t*>(ptr + n * sizeof( double ));
+         const auto* xs = reinterpret_cast<const float*>(ptr + n * (sizeof( double ) + sizeof( int32_t )));
+         const auto* ys = xs + n;
+         for (size_t i = 0; i < n; ++i) {
+            if (timestamps[i] < begin_time || timestamps[i] > end_time) continue;
+
+            const cv::Point2f position(xs[i], ys[i]);
+            if (is_inside( position )) results.push_back( { timestamps[i], ids[i], position } );
+         }
+      }
+   }
+}
+
+void SpatioTemporalIndexReader::query(
+   std::vector<PositionRecord>& results,
+   const cv::Rect2f& area_in_meter,
+   double begin_time,
+   double end_time
+) const
+{
+   scan(
+      results, area_in_meter, begin_time, end_time,
+      [&area_in_meter](const cv::Point2f& position)
+      {
+         return area_in_meter.x <= position.x && position.x <= area_in_meter.x + area_in_meter.width &&
+            area_in_meter.y <= position.y && position.y <= area_in_meter.y + area_in_meter.height;
+      }
+   );
+}
+
+void SpatioTemporalIndexReader::query(
+   std::vector<PositionRecord>& results,
+   const std::vector<cv::Point2f>& polygon_in_meter,
+   double begin_time,
+   double end_time
+) const
+{
+   if (polygon_in_meter.size() < 3) return;
+
+   float min_x = polygon_in_meter[0].x, min_y = polygon_in_meter[0].y;
+   float max_x = min_x, max_y = min_y;
+   for (const auto& point : polygon_in_meter) {
+      min_x = std::min( min_x, point.x );
+      min_y = std::min( min_y, point.y );
+      max_x = std::max( max_x, point.x );
+      max_y = std::max( max_y, point.y );
+   }
+   scan(
+      results, cv::Rect2f(min_x, min_y, max_x - min_x, max_y - min_y), begin_time, end_time,
+      [&polygon_in_meter](const cv::Point2f& position) { return isInsidePolygon( position, polygon_in_meter ); }
+   );
+}
+
+void SpatioTemporalIndexReader::query(
+   std::vector<PositionRecord>& results,
+   const ZoneScene& scene,
+   int zone_index,
+   float meter_to_pixel,
+   double begin_time,
+   double end_time
+) const
+// the zone is in pixels of the world map, so its bounding box is converted to meter.
+{
+   if (zone_index < 0 || zone_index >= scene.getZoneNum() || !scene.hasEdges( zone_index )) return;
+
+   const cv::Rect2f bounds(
+      scene.MinX[zone_index] / meter_to_pixel,
+      scene.MinY[zone_index] / meter_to_pixel,
+      (scene.MaxX[zone_index] - scene.MinX[zone_index]) / meter_to_pixel,
+      (scene.MaxY[zone_index] - scene.MinY[zone_index]) / meter_to_pixel
+   );
+   scan(
+      results, bounds, begin_time, end_time,
+      [&scene, zone_index, meter_to_pixel](const cv::Point2f& position)
+      {
+         return scene.isInsideZone( position * meter_to_pixel, zone_index );
+      }
+   );
+}
\ No newline at end of file
@@ -0,0 +1,149 @@
+/*
+ * Author: Emoy Kim
+ * E-mail: emoy.kim_AT_gmail.com
+ *
+ * This code is a free software; it can be freely used, changed and redistributed.
+ * If you use any version of the code, please reference the code.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "ZoneArrangement.h"
+#include "EventLog.h"
+
+// Index of positions on the world map over time, stored in the native (little-endian) byte order.
+//
+//  [header] [block 0] [block 1] ... [chunk index] [block index]
+//
+// Records are partitioned into chunks of ChunkDuration seconds, and the records of a chunk are sorted by
+// the Hilbert curve order of their cells of CellSize meters, so that each block of up to BlockCapacity records
+// covers a compact area. Each column of a block is contiguous in this order: timestamps(double), ids(int32),
+// x(m), y(m) (float), and blocks start at multiples of 8 bytes. The block index has the time range and
+// the bounding box of each block, so a query reads only the blocks which overlap it.
+struct SpatioTemporalIndexHeader
+{
+   char Magic[8];
+   uint32_t Version;
+   uint32_t BlockCapacity;
+   double ChunkDuration;
+   float CellSize;
+   uint32_t Reserved;
+   uint64_t RecordNum;
+   uint64_t ChunkNum;
+   uint64_t BlockNum;
+   uint64_t ChunkIndexOffset;
+   uint64_t BlockIndexOffset;
+};
+
+struct SpatioTemporalChunkInfo
+{
+   double MinTimestamp;
+   double MaxTimestamp;
+   uint64_t FirstBlock;
+   uint64_t BlockNum;
+};
+
+struct SpatioTemporalBlockInfo
+{
+   uint64_t Offset;
+   uint64_t RecordNum;
+   double MinTimestamp;
+   double MaxTimestamp;
+   float MinX;
+   float MinY;
+   float MaxX;
+   float MaxY;
+};
+
+// Id is the track id of a track, or the camera index of a localized detection.
+struct PositionRecord
+{
+   double Timestamp;
+   int32_t Id;
+   cv::Point2f PositionInMeter;
+};
+
+class SpatioTemporalIndexWriter
+{
+public:
+   explicit SpatioTemporalIndexWriter(double chunk_duration = 60.0, float cell_size_in_meter = 1.0f, size_t block_capacity = 1024);
+   ~SpatioTemporalIndexWriter() { close(); }
+
+   bool open(const std::string& path);
+   bool close();
+   bool isOpen() const { return File.is_open(); }
+
+   // records should be roughly in time order. A late record joins the current chunk, whose time range covers it.
+   void write(const PositionRecord& record);
+   void write(const LocalizedDetection& localized); // invalid ones are skipped
+
+private:
+   std::ofstream File;
+   double ChunkDuration;
+   float CellSize;
+   uint32_t BlockCapacity;
+   uint64_t RecordNum;
+   double ChunkEnd;
+   std::vector<PositionRecord> Records; // of the current chunk
+   std::vector<std::pair<uint32_t, uint32_t>> SortKeys; // Hilbert key and record index
+   std::vector<SpatioTemporalChunkInfo> ChunkIndex;
+   std::vector<SpatioTemporalBlockInfo> BlockIndex;
+   std::vector<double> Timestamps;
+   std::vector<int32_t> Ids;
+   std::vector<float> Xs;
+   std::vector<float> Ys;
+
+   void flushChunk();
+   void flushBlock(size_t begin, size_t end);
+};
+
+class SpatioTemporalIndexReader
+{
+public:
+   SpatioTemporalIndexReader() : Header(), ReadBlockNum( 0 ) {}
+   ~SpatioTemporalIndexReader() = default;
+
+   bool open(const std::string& path);
+   size_t getRecordNum() const { return static_cast<size_t>(Header.RecordNum); }
+
+   // records in [begin_time, end_time] inside the area, which are appended to the results.
+   void query(std::vector<PositionRecord>& results, const cv::Rect2f& area_in_meter, double begin_time, double end_time) const;
+   void query(
+      std::vector<PositionRecord>& results,
+      const std::vector<cv::Point2f>& polygon_in_meter,
+      double begin_time,
+      double end_time
+   ) const;
+   void query(
+      std::vector<PositionRecord>& results,
+      const ZoneScene& scene,
+      int zone_index,
+      float meter_to_pixel,
+      double begin_time,
+      double end_time
+   ) const;
+
+   size_t getReadBlockNum() const { return ReadBlockNum; } // by the last query
+
+private:
+   MappedFile File;
+   SpatioTemporalIndexHeader Header;
+   ColumnSpan<SpatioTemporalChunkInfo> ChunkIndex;
+   ColumnSpan<SpatioTemporalBlockInfo> BlockIndex;
+   mutable size_t ReadBlockNum;
+
+   template<typename Predicate>
+   void scan(
+      std::vector<PositionRecord>& results,
+      const cv::Rect2f& bounds,
+      double begin_time,
+      double end_time,
+      Predicate is_inside
+   ) const;
+};
\ No newline at end of file
@@ -0,0 +1,71 @@
+/*
+ * Author: Emoy Kim
+ * E-mail: emoy.kim_AT_gmail.com
+ *
+ * This code is a free software; it can be freely used, changed and redistributed.
+ * If you use any version of the code, please reference the code.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <atomic>
+#include <vector>
+
+// Lock-free ring buffer between exactly one producer thread and one consumer thread.
+// The capacity is rounded up to a power of two. Head and Tail are on their own cache lines, and each side
+// caches the other side's index so that it reads the shared one only when the ring looks full or empty.
+template<typename T>
+class SpscQueue
+{
+public:
+   explicit SpscQueue(size_t capacity) : Mask( roundUpToPowerOfTwo( capacity ) - 1 ), Buffer( Mask + 1 ),
+      Head( 0 ), CachedTail( 0 ), Tail( 0 ), CachedHead( 0 ) {}
+   ~SpscQueue() = default;
+   SpscQueue(const SpscQueue&) = delete;
+   SpscQueue& operator=(const SpscQueue&) = delete;
+
+   // producer side
+   bool tryPush(const T& item)
+   {
+      const size_t tail = Tail.load( std::memory_order_relaxed );
+      if (tail - CachedHead > Mask) {
+         CachedHead = Head.load( std::memory_order_acquire );
+         if (tail - CachedHead > Mask) return false;
+      }
+      Buffer[tail & Mask] = item;
+      Tail.store( tail + 1, std::memory_order_release );
+      return true;
+   }
+
+   // consumer side
+   const T* front()
+   {
+      const size_t head = Head.load( std::memory_order_relaxed );
+      if (head == CachedTail) {
+         CachedTail = Tail.load( std::memory_order_acquire );
+         if (head == CachedTail) return nullptr;
+      }
+      return &Buffer[head & Mask];
+   }
+
+   void pop() { Head.store( Head.load( std::memory_order_relaxed ) + 1, std::memory_order_release ); }
+
+   size_t capacity() const { return Mask + 1; }
+
+private:
+   static size_t roundUpToPowerOfTwo(size_t n)
+   {
+      size_t power = 1;
+      while (power < n) power <<= 1;
+      return power;
+   }
+
+   const size_t Mask;
+   std::vector<T> Buffer;
+   alignas(64) std::atomic<size_t> Head;
+   size_t CachedTail; // used only by the consumer
+   alignas(64) std::atomic<size_t> Tail;
+   size_t CachedHead; // used only by the producer
+};
\ No newline at end of file
@@ -0,0 +1,332 @@
+#include "TrajectoryStore.h"
+
+#include <chrono>
+#include <random>
+
+namespace
+{
+   constexpr char TrajectoryStoreMagic[8] = { 'L', 'D', 'T', 'R', 'A', 'J', '\0', '\0' };
+   constexpr uint32_t TrajectoryStoreVersion = 1;
+
+   uint64_t encodeZigzag(int64_t value) { return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63); }
+   int64_t decodeZigzag(uint64_t value) { return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1); }
+
+   void writeVarint(std::vector<uint8_t>& buffer, uint64_t value)
+   {
+      while (value >= 0x80) {
+         buffer.emplace_back( static_cast<uint8_t>(value | 0x80) );
+         value >>= 7;
+      }
+      buffer.emplace_back( static_cast<uint8_t>(value) );
+   }
+
+   void writeSignedVarint(std::vector<uint8_t>& buffer, int64_t value) { writeVarint( buffer, encodeZigzag( value ) ); }
+
+   // returns false if the varint runs over the end.
+   bool readVarint(uint64_t& value, const uint8_t*& ptr, const uint8_t* end)
+   {
+      value = 0;
+      for (int shift = 0; shift < 64 && ptr < end; shift += 7) {
+         const uint8_t byte = *ptr++;
+         value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+         if ((byte & 0x80) == 0) return true;
+      }
+      return false;
+   }
+
+   bool readSignedVarint(int64_t& value, const uint8_t*& ptr, const uint8_t* end)
+   {
+      uint64_t encoded;
+      if (!readVarint( encoded, ptr, end )) return false;
+      value = decodeZigzag( encoded );
+      return true;
+   }
+}
+
+TrajectoryWriter::TrajectoryWriter(double resolution_in_meter, double time_resolution, size_t block_capacity) :
+   Resolution( resolution_in_meter ), TimeResolution( time_resolution ),
+   BlockCapacity( static_cast<uint32_t>(std::max( block_capacity, static_cast<size_t>(1) )) ), PointNum( 0 ),
+   WrittenBytes( 0 ), MinTimestamp( std::numeric_limits<double>::infinity() ),
+   MaxTimestamp( -std::numeric_limits<double>::infinity() )
+{
+}
+
+bool TrajectoryWriter::open(const std::string& path)
+{
+   close();
+   File.open( path, std::ios::binary | std::ios::trunc );
+   if (!File.is_open()) return false;
+
+   PointNum = 0;
+   BlockIndex.clear();
+   const TrajectoryStoreHeader header{};
+   File.write( reinterpret_cast<const char*>(&header), sizeof( header ) );
+   WrittenBytes = sizeof( header );
+   return File.good();
+}
+
+void TrajectoryWriter::append(const PositionRecord& point)
+{
+   Points.push_back(
+      {
+         point.Id,
+         llround( point.Timestamp / TimeResolution ),
+         llround( point.PositionInMeter.x / Resolution ),
+         llround( point.PositionInMeter.y / Resolution )
+      }
+   );
+   MinTimestamp = std::min( MinTimestamp, point.Timestamp );
+   MaxTimestamp = std::max( MaxTimestamp, point.Timestamp );
+   if (Points.size() == BlockCapacity) flushBlock();
+}
+
+void TrajectoryWriter::flushBlock()
+{
+   if (Points.empty()) return;
+
+   std::stable_sort(
+      Points.begin(), Points.end(),
+      [](const QuantizedPoint& a, const QuantizedPoint& b) { return a.Id < b.Id || (a.Id == b.Id && a.Time < b.Time); }
+   );
+
+   TrajectoryBlockInfo info{};
+   info.Offset = WrittenBytes;
+   info.PointNum = Points.size();
+   info.BaseTime = llround( MinTimestamp / TimeResolution );
+   info.MinTimestamp = MinTimestamp;
+   info.MaxTimestamp = MaxTimestamp;
+
+   Encoded.clear();
+   int32_t previous_id = 0;
+   for (size_t begin = 0; begin < Points.size();) {
+      size_t end = begin + 1;
+      while (end < Points.size() && Points[end].Id == Points[begin].Id) ++end;
+
+      writeSignedVarint( Encoded, static_cast<int64_t>(Points[begin].Id) - previous_id );
+      writeVarint( Encoded, end - begin );
+      previous_id = Points[begin].Id;
+
+      int64_t dt = 0, dx = 0, dy = 0;
+      for (size_t i = begin; i < end; ++i) {
+         const QuantizedPoint& point = Points[i];
+         if (i == begin) {
+            writeSignedVarint( Encoded, point.Time - info.BaseTime );
+            writeSignedVarint( Encoded, point.X );
+            writeSignedVarint( Encoded, point.Y );
+            continue;
+         }
+         const QuantizedPoint& previous = Points[i - 1];
+         const int64_t next_dt = point.Time - previous.Time;
+         const int64_t next_dx = point.X - previous.X;
+         const int64_t next_dy = point.Y - previous.Y;
+         writeSignedVarint( Encoded, next_dt - dt );
+         writeSignedVarint( Encoded, next_dx - dx );
+         writeSignedVarint( Encoded, next_dy - dy );
+         dt = next_dt;
+         dx = next_dx;
+         dy = next_dy;
+      }
+      begin = end;
+   }
+   info.ByteSize = Encoded.size();
+   BlockIndex.emplace_back( info );
+   File.write( reinterpret_cast<const char*>(Encoded.data()), static_cast<std::streamsize>(Encoded.size()) );
+   WrittenBytes += Encoded.size();
+   PointNum += Points.size();
+
+   Points.clear();
+   MinTimestamp = std::numeric_limits<double>::infinity();
+   MaxTimestamp = -std::numeric_limits<double>::infinity();
+}
+
+bool TrajectoryWriter::close()
+{
+   if (!File.is_open()) return false;
+
+   flushBlock();
+   TrajectoryStoreHeader header{};
+   std::copy( TrajectoryStoreMagic, TrajectoryStoreMagic + sizeof( header.Magic ), header.Magic );
+   header.Version = TrajectoryStoreVersion;
+   header.BlockCapacity = BlockCapacity;
+   header.Resolution = Resolution;
+   header.TimeResolution = TimeResolution;
+   header.PointNum = PointNum;
+   header.BlockNum = BlockIndex.size();
+
+   // the block index is aligned to 8 bytes, so that it is read in place.
+   const uint64_t padding = (8 - WrittenBytes % 8) % 8;
+   File.write( "\0\0\0\0\0\0\0\0", static_cast<std::streamsize>(padding) );
+   header.IndexOffset = WrittenBytes + padding;
+   File.write( reinterpret_cast<const char*>(BlockIndex.data()), static_cast<std::streamsize>(BlockIndex.size() * sizeof( TrajectoryBlockInfo )) );
+   WrittenBytes = header.IndexOffset + BlockIndex.size() * sizeof( TrajectoryBlockInfo );
+   File.seekp( 0 );
+   File.write( reinterpret_cast<const char*>(&header), sizeof( header ) );
+
+   const bool succeeded = File.good();
+   File.close();
+   return succeeded;
+}
+
+bool TrajectoryReader::open(const std::string& path)
+{
+   BlockIndex = ColumnSpan<TrajectoryBlockInfo>();
+   if (!File.open( path ) || File.size() < sizeof( TrajectoryStoreHeader )) return false;
+
+   std::copy( File.data(), File.data() + sizeof( Header ), reinterpret_cast<char*>(&Header) );
+   // the sizes are compared by division, so a corrupt header cannot overflow them.
+   if (!std::equal( TrajectoryStoreMagic, TrajectoryStoreMagic + sizeof( Header.Magic ), Header.Magic ) ||
+       Header.Version != TrajectoryStoreVersion || Header.IndexOffset % 8 != 0 ||
+       Header.IndexOffset < sizeof( TrajectoryStoreHeader ) || Header.IndexOffset > File.size() ||
+       Header.BlockNum > (File.size() - Header.IndexOffset) / sizeof( TrajectoryBlockInfo )) {
+      File.close();
+      return false;
+   }
+
+   BlockIndex = ColumnSpan<TrajectoryBlockInfo>(
+      reinterpret_cast<const TrajectoryBlockInfo*>(File.data() + Header.IndexOffset), static_cast<size_t>(Header.BlockNum)
+   );
+   for (const auto& info : BlockIndex) {
+      if (info.Offset < sizeof( TrajectoryStoreHeader ) || info.Offset > Header.IndexOffset ||
+          info.ByteSize > Header.IndexOffset - info.Offset) {
+         File.close();
+         BlockIndex = ColumnSpan<TrajectoryBlockInfo>();
+         return false;
+      }
+   }
+   return true;
+}
+
+size_t TrajectoryReader::seek(double timestamp) const
+{
+   const auto it = std::partition_point(
+      BlockIndex.begin(), BlockIndex.end(),
+      [timestamp](const TrajectoryBlockInfo& info) { return info.MaxTimestamp < timestamp; }
+   );
+   return static_cast<size_t>(it - BlockIndex.begin());
+}
+
+bool TrajectoryReader::decodeBlock(std::vector<PositionRecord>& points, size_t i) const
+{
+   const TrajectoryBlockInfo& info = BlockIndex[i];
+   const auto* ptr = reinterpret_cast<const uint8_t*>(File.data() + info.Offset);
+   const uint8_t* end = ptr + info.ByteSize;
+   const auto resolution = static_cast<float>(Header.Resolution);
+
+   uint64_t decoded_num = 0;
+   int64_t id = 0;
+   while (decoded_num < info.PointNum) {
+      int64_t id_delta;
+      uint64_t point_num;
+      if (!readSignedVarint( id_delta, ptr, end ) || !readVarint( point_num, ptr, end ) ||
+          point_num == 0 || decoded_num + point_num > info.PointNum) return false;
+      id += id_delta;
+
+      int64_t t = 0, x = 0, y = 0, dt = 0, dx = 0, dy = 0;
+      for (uint64_t k = 0; k < point_num; ++k) {
+         int64_t a, b, c;
+         if (!readSignedVarint( a, ptr, end ) || !readSignedVarint( b, ptr, end ) || !readSignedVarint( c, ptr, end )) return false;
+         if (k == 0) {
+            t = info.BaseTime + a;
+            x = b;
+            y = c;
+         }
+         else {
+            dt += a;
+            dx += b;
+            dy += c;
+            t += dt;
+            x += dx;
+            y += dy;
+         }
+         points.push_back(
+            {
+               static_cast<double>(t) * Header.TimeResolution,
+               static_cast<int32_t>(id),
+               cv::Point2f(static_cast<float>(x) * resolution, static_cast<float>(y) * resolution)
+            }
+         );
+      }
+      decoded_num += point_num;
+   }
+   return ptr == end;
+}
+
+bool TrajectoryReader::read(std::vector<PositionRecord>& points, double begin_time, double end_time) const
+{
+   std::vector<PositionRecord> block_points;
+   for (size_t i = seek( begin_time ); i < BlockIndex.Size && BlockIndex[i].MinTimestamp <= end_time; ++i) {
+      block_points.clear();
+      if (!decodeBlock( block_points, i )) return false;
+
+      for (const auto& point : block_points) {
+         if (begin_time <= point.Timestamp && point.Timestamp <= end_time) points.emplace_back( point );
+      }
+   }
+   return true;
+}
+
+bool benchmarkTrajectoryStore(const std::string& path, double resolution_in_meter, int track_num, double duration)
+{
+   constexpr double frame_interval = 1.0 / 30.0;
+   std::mt19937 generator(0);
+   std::uniform_real_distribution<float> position(0.0f, 90.0f);
+   std::normal_distribution<float> turn(0.0f, 0.05f);
+   std::vector<cv::Point2f> positions(track_num), velocities(track_num);
+   for (int i = 0; i < track_num; ++i) {
+      positions[i] = cv::Point2f(position( generator ), position( generator ));
+      velocities[i] = cv::Point2f(1.4f, 0.0f);
+   }
+
+   TrajectoryWriter writer(resolution_in_meter);
+   if (!writer.open( path )) {
+      std::cerr << "Cannot Open the Trajectory Store: " << path << "\n";
+      return false;
+   }
+   uint64_t point_num = 0;
+   std::chrono::steady_clock::duration encoding_time{};
+   std::vector<PositionRecord> frame(track_num);
+   for (double t = 0.0; t < duration; t += frame_interval) {
+      for (int i = 0; i < track_num; ++i) {
+         const float angle = turn( generator );
+         velocities[i] = cv::Point2f(
+            velocities[i].x * cos( angle ) - velocities[i].y * sin( angle ),
+            velocities[i].x * sin( angle ) + velocities[i].y * cos( angle )
+         );
+         positions[i] += velocities[i] * static_cast<float>(frame_interval);
+         frame[i] = { t, i, positions[i] };
+      }
+      const auto start = std::chrono::steady_clock::now();
+      for (const auto& point : frame) writer.append( point );
+      encoding_time += std::chrono::steady_clock::now() - start;
+      point_num += track_num;
+   }
+   const auto start = std::chrono::steady_clock::now();
+   if (!writer.close()) return false;
+   encoding_time += std::chrono::steady_clock::now() - start;
+
+   TrajectoryReader reader;
+   if (!reader.open( path )) {
+      std::cerr << "Cannot Open the Trajectory Store: " << path << "\n";
+      return false;
+   }
+   std::vector<PositionRecord> points;
+   points.reserve( 4096 );
+   const auto decoding_start = std::chrono::steady_clock::now();
+   for (size_t i = 0; i < reader.getBlockNum(); ++i) {
+      points.clear();
+      if (!reader.decodeBlock( points, i )) {
+         std::cerr << "Cannot Decode the Block " << i << "\n";
+         return false;
+      }
+   }
+   const double decoding_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - decoding_start).count();
+   const double encoding_seconds = std::chrono::duration<double>(encoding_time).count();
+
+   const double raw_bytes = static_cast<double>(point_num) * (sizeof( double ) + 3 * sizeof( int32_t ));
+   const auto stored_bytes = static_cast<double>(writer.getWrittenBytes());
+   std::cout << point_num << " points, " << stored_bytes / static_cast<double>(point_num) << " bytes per point, "
+      << "compression ratio " << raw_bytes / stored_bytes << "\n"
+      << "encoding: " << static_cast<double>(point_num) / encoding_seconds << " points/s, "
+      << "decoding: " << static_cast<double>(point_num) / decoding_seconds << " points/s\n";
+   return true;
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+/*
+ * Author: Emoy Kim
+ * E-mail: emoy.kim_AT_gmail.com
+ *
+ * This code is a free software; it can be freely used, changed and redistributed.
+ * If you use any version of the code, please reference the code.
+ *
+ */
+
+#pragma once
+
+#include "SpatioTemporalIndex.h"
+
+// Compressed store of track positions, stored in the native (little-endian) byte order.
+//
+//  [header] [block 0] [block 1] ... [block index]
+//
+// Times and positions are quantized to TimeResolution seconds and Resolution meters. A block has up to BlockCapacity
+// points grouped by track, and it is decoded without any other block. For each track in a block:
+//  varint(zigzag(id - previous id)), varint(point number),
+//  the first point as zigzag varints of (t - block base time, x, y),
+//  the second point as zigzag varints of the deltas (dt, dx, dy),
+//  and the other points as zigzag varints of the changes of the deltas, which are mostly 0 or so at a steady pace.
+// The block index at the end has the offset, the time range and the base time of each block. Points should be appended
+// in time order, so the blocks are in time order and a block of a time is found by a binary search.
+struct TrajectoryStoreHeader
+{
+   char Magic[8];
+   uint32_t Version;
+   uint32_t BlockCapacity;
+   double Resolution;
+   double TimeResolution;
+   uint64_t PointNum;
+   uint64_t BlockNum;
+   uint64_t IndexOffset;
+};
+
+struct TrajectoryBlockInfo
+{
+   uint64_t Offset;
+   uint64_t ByteSize;
+   uint64_t PointNum;
+   int64_t BaseTime; // in TimeResolution
+   double MinTimestamp;
+   double MaxTimestamp;
+};
+
+class TrajectoryWriter
+{
+public:
+   // the resolution is usually 1 / MeterToPixel, i.e. one pixel of the world map.
+   explicit TrajectoryWriter(double resolution_in_meter, double time_resolution = 1e-3, size_t block_capacity = 4096);
+   ~TrajectoryWriter() { close(); }
+
+   bool open(const std::string& path);
+   bool close();
+   bool isOpen() const { return File.is_open(); }
+   void append(const PositionRecord& point);
+   uint64_t getWrittenBytes() const { return WrittenBytes; }
+
+private:
+   struct QuantizedPoint
+   {
+      int32_t Id;
+      int64_t Time;
+      int64_t X;
+      int64_t Y;
+   };
+
+   std::ofstream File;
+   double Resolution;
+   double TimeResolution;
+   uint32_t BlockCapacity;
+   uint64_t PointNum;
+   uint64_t WrittenBytes;
+   double MinTimestamp;
+   double MaxTimestamp;
+   std::vector<QuantizedPoint> Points; // of the current block
+   std::vector<uint8_t> Encoded;
+   std::vector<TrajectoryBlockInfo> BlockIndex;
+
+   void flushBlock();
+};
+
+class TrajectoryReader
+{
+public:
+   TrajectoryReader() : Header() {}
+   ~TrajectoryReader() = default;
+
+   bool open(const std::string& path);
+   size_t getPointNum() const { return static_cast<size_t>(Header.PointNum); }
+   size_t getBlockNum() const { return BlockIndex.Size; }
+   const TrajectoryBlockInfo& getBlockInfo(size_t i) const { return BlockIndex[i]; }
+
+   // the first block which may have a point at or after the timestamp, or getBlockNum() if none.
+   size_t seek(double timestamp) const;
+
+   // points of the block are appended grouped by track, and each track is in time order.
+   bool decodeBlock(std::vector<PositionRecord>& points, size_t i) const;
+
+   // points in [begin_time, end_time], which are appended from the blocks found by seek().
+   bool read(std::vector<PositionRecord>& points, double begin_time, double end_time) const;
+
+private:
+   MappedFile File;
+   TrajectoryStoreHeader Header;
+   ColumnSpan<TrajectoryBlockInfo> BlockIndex;
+};
+
+// writes synthetic walks of the tracks at 30Hz, and reports the compression ratio against raw records of
+// a double and three 32-bit values, and the encoding and decoding throughput.
+bool benchmarkTrajectoryStore(const std::string& path, double resolution_in_meter, int track_num, double duration);
\ No newline at end of file
@@ -0,0 +1,78 @@
+#include "Triangulation.h"
+
+Triangulation::Triangulation(const LocationDetection& location_detector, float max_residual_in_meter) :
+   Cameras( location_detector.getCameras() ), MaxResidual( max_residual_in_meter )
+{
+}
+
+void Triangulation::solve(TriangulatedLocation& location, int begin, int end) const
+// minimizes sum of w * |(I - d * d^t)(p - o)|^2, so that (sum of w * (I - d * d^t)) * p = sum of w * (I - d * d^t) * o.
+{
+   location = TriangulatedLocation();
+   cv::Matx33d normal_matrix = cv::Matx33d::zeros();
+   cv::Vec3d normal_vector(0.0, 0.0, 0.0);
+   double weight_sum = 0.0;
+   for (int i = begin; i < end; ++i) {
+      if (Weights[i] <= 0.0f) continue;
+
+      const double w = Weights[i];
+      const cv::Vec3d d(Directions[i].x, Directions[i].y, Directions[i].z);
+      const cv::Vec3d o(Origins[i].x, Origins[i].y, Origins[i].z);
+      const cv::Matx33d projection = cv::Matx33d::eye() - d * d.t();
+      normal_matrix += w * projection;
+      normal_vector += w * (projection * o);
+      weight_sum += w;
+      location.ObservationNum++;
+   }
+   if (location.ObservationNum < 2) return;
+
+   // the determinant of the normalized matrix is 0 when all rays are parallel and 1 at most,
+   // so a tiny one means that the depth along the rays cannot be determined.
+   const cv::Matx33d normalized = normal_matrix * (1.0 / weight_sum);
+   if (cv::determinant( normalized ) < 1e-6) return;
+
+   const cv::Vec3d p = normalized.solve( normal_vector * (1.0 / weight_sum), cv::DECOMP_CHOLESKY );
+   double squared_residual = 0.0;
+   for (int i = begin; i < end; ++i) {
+      if (Weights[i] <= 0.0f) continue;
+
+      const cv::Vec3d v = p - cv::Vec3d(Origins[i].x, Origins[i].y, Origins[i].z);
+      const double depth = v.dot( cv::Vec3d(Directions[i].x, Directions[i].y, Directions[i].z) );
+      if (depth <= 0.0) return;
+      squared_residual += Weights[i] * (v.dot( v ) - depth * depth);
+   }
+   location.ActualPositionInMeter = cv::Point2f(static_cast<float>(p[0]), static_cast<float>(p[1]));
+   location.AltitudeInMeter = static_cast<float>(p[2]);
+   location.ResidualInMeter = static_cast<float>(std::sqrt( std::max( squared_residual, 0.0 ) / weight_sum ));
+   location.IsValid = location.ResidualInMeter <= MaxResidual;
+}
+
+void Triangulation::triangulate(
+   std::vector<TriangulatedLocation>& locations,
+   const std::vector<CameraObservation>& observations,
+   const std::vector<int>& group_offsets
+)
+{
+   const auto observation_num = observations.size();
+   if (Origins.size() < observation_num) {
+      Origins.resize( observation_num );
+      Directions.resize( observation_num );
+      Weights.resize( observation_num );
+   }
+   const int camera_num = Cameras.size();
+   for (size_t i = 0; i < observation_num; ++i) {
+      const CameraObservation& observation = observations[i];
+      if (observation.CameraIndex < 0 || observation.CameraIndex >= camera_num) {
+         Weights[i] = 0.0f;
+         continue;
+      }
+      Cameras.getViewingRay( Origins[i], Directions[i], observation.CameraPoint, observation.CameraIndex );
+      Weights[i] = observation.Weight;
+   }
+
+   const int group_num = group_offsets.empty() ? 0 : static_cast<int>(group_offsets.size()) - 1;
+   locations.resize( group_num );
+   for (int i = 0; i < group_num; ++i) {
+      solve( locations[i], group_offsets[i], group_offsets[i + 1] );
+   }
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+/*
+ * Author: Emoy Kim
+ * E-mail: emoy.kim_AT_gmail.com
+ *
+ * This code is a free software; it can be freely used, changed and redistributed.
+ * If you use any version of the code, please reference the code.
+ *
+ */
+
+#pragma once
+
+#include "LocationDetection.h"
+
+struct CameraObservation
+{
+   int CameraIndex; // the order in which the camera is set
+   cv::Point2f CameraPoint;
+   float Weight;
+
+   CameraObservation() : CameraIndex( -1 ), Weight( 0.0f ) {}
+   CameraObservation(int camera_index, const cv::Point2f& camera_point, float weight = 1.0f) :
+      CameraIndex( camera_index ), CameraPoint( camera_point ), Weight( weight ) {}
+};
+
+struct TriangulatedLocation
+{
+   cv::Point2f ActualPositionInMeter;
+   float AltitudeInMeter;
+   float ResidualInMeter; // weighted RMS distance from the location to the viewing rays
+   int ObservationNum;
+   bool IsValid;
+
+   TriangulatedLocation() : AltitudeInMeter( 0.0f ), ResidualInMeter( 0.0f ), ObservationNum( 0 ), IsValid( false ) {}
+};
+
+// Fuses the observations of the same target from several cameras into one location.
+// Each observation is a viewing ray from its camera, and the location is the point whose weighted sum of
+// squared distances to the rays is minimal, so its altitude is also found instead of assumed.
+// The rays are kept in the workspace of this object which only grows, so use one object per thread.
+class Triangulation
+{
+public:
+   explicit Triangulation(const LocationDetection& location_detector, float max_residual_in_meter = 0.5f);
+   ~Triangulation() = default;
+
+   // the observations of the i-th group are in [group_offsets[i], group_offsets[i + 1]).
+   // a location is not valid if its group has less than two usable observations, the rays are almost parallel,
+   // the location is behind a camera, or the residual is larger than the maximum.
+   void triangulate(
+      std::vector<TriangulatedLocation>& locations,
+      const std::vector<CameraObservation>& observations,
+      const std::vector<int>& group_offsets
+   );
+
+private:
+   const CameraStore& Cameras;
+   float MaxResidual;
+   std::vector<cv::Point3f> Origins;
+   std::vector<cv::Point3f> Directions;
+   std::vector<float> Weights;
+
+   void solve(TriangulatedLocation& location, int begin, int end) const;
+};
\ No newline at end of file
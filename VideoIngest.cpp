@@ -0,0 +1,150 @@
+#include "VideoIngest.h"
+
+double VideoIngest::StageStatistics::getFPS() const
+{
+   const double seconds = std::chrono::duration<double>(BusyTime).count();
+   return seconds > 0.0 ? static_cast<double>(FrameNum) / seconds : 0.0;
+}
+
+VideoIngest::VideoIngest(const LocationDetection& location_detector, int min_blob_area, size_t queue_capacity) :
+   LocationDetector( location_detector ), MinBlobArea( min_blob_area ),
+   QueueCapacity( std::max( queue_capacity, static_cast<size_t>(1) ) )
+{
+}
+
+bool VideoIngest::addCamera(int camera_index, const std::string& video_path)
+{
+   if (camera_index < 0 || camera_index >= LocationDetector.getCameraNum()) {
+      std::cerr << "Cannot Find the Camera#" << camera_index << "\n";
+      return false;
+   }
+
+   auto pipeline = std::make_unique<CameraPipeline>();
+   pipeline->CameraIndex = camera_index;
+   pipeline->VideoPath = video_path;
+   if (!pipeline->Capture.open( video_path )) {
+      std::cerr << "Cannot Open the Video: " << video_path << "\n";
+      return false;
+   }
+   pipeline->FloorMask = LocationDetector.getValidFloorMask( camera_index );
+   LocationDetector.getPerspectiveScaleMap( pipeline->ScaleMap, camera_index );
+   Pipelines.emplace_back( std::move( pipeline ) );
+   return true;
+}
+
+void VideoIngest::decode(CameraPipeline& pipeline, BoundedQueue<Frame>& decoded)
+{
+   while (true) {
+      const auto start = std::chrono::steady_clock::now();
+      Frame frame;
+      if (!pipeline.Capture.read( frame.Image ) || frame.Image.empty()) break;
+      frame.Timestamp = pipeline.Capture.get( cv::CAP_PROP_POS_MSEC ) * 1e-3;
+      pipeline.Decoding.BusyTime += std::chrono::steady_clock::now() - start;
+      pipeline.Decoding.FrameNum++;
+      if (!decoded.push( std::move( frame ) )) break;
+   }
+   decoded.close();
+}
+
+void VideoIngest::segment(CameraPipeline& pipeline, BoundedQueue<Frame>& decoded, BoundedQueue<std::vector<Detection>>& segmented) const
+// shadows are marked as 127 by MOG2, so they are thresholded out before the blobs are labeled.
+{
+   const cv::Ptr<cv::BackgroundSubtractorMOG2> subtractor = cv::createBackgroundSubtractorMOG2( 500, 16.0, true );
+   const cv::Mat kernel = cv::getStructuringElement( cv::MORPH_ELLIPSE, cv::Size(3, 3) );
+   constexpr float min_height_ratio = 0.25f; // of the expected height of a person, below which a blob is noise
+   const cv::Size camera_size = pipeline.FloorMask.Size;
+   RunLengthMask floor_mask;
+   cv::Rect roi;
+   cv::Mat foreground, labels, stats, centroids;
+   Frame frame;
+   while (decoded.pop( frame )) {
+      const auto start = std::chrono::steady_clock::now();
+      if (floor_mask.Size != frame.Image.size()) {
+         pipeline.FloorMask.resize( floor_mask, frame.Image.size() );
+         roi = floor_mask.getBoundingRect();
+      }
+      const float scale_x = static_cast<float>(camera_size.width) / static_cast<float>(frame.Image.cols);
+      const float scale_y = static_cast<float>(camera_size.height) / static_cast<float>(frame.Image.rows);
+
+      int label_num = 0;
+      if (!roi.empty()) {
+         subtractor->apply( frame.Image( roi ), foreground );
+         cv::threshold( foreground, foreground, 200.0, 255.0, cv::THRESH_BINARY );
+         floor_mask.apply( foreground, roi );
+         cv::morphologyEx( foreground, foreground, cv::MORPH_OPEN, kernel );
+         label_num = cv::connectedComponentsWithStats( foreground, labels, stats, centroids, 8, CV_32S );
+      }
+
+      std::vector<Detection> detections;
+      for (int label = 1; label < label_num; ++label) {
+         if (stats.at<int>(label, cv::CC_STAT_AREA) < MinBlobArea) continue;
+
+         const int left = roi.x + stats.at<int>(label, cv::CC_STAT_LEFT);
+         const int top = roi.y + stats.at<int>(label, cv::CC_STAT_TOP);
+         const int width = stats.at<int>(label, cv::CC_STAT_WIDTH);
+         const int height = stats.at<int>(label, cv::CC_STAT_HEIGHT);
+         const cv::Point2f foot_point(
+            (static_cast<float>(left) + static_cast<float>(width) * 0.5f) * scale_x,
+            static_cast<float>(top + height - 1) * scale_y
+         );
+         const float expected_height = pipeline.ScaleMap.getPixelHeight( foot_point );
+         if (expected_height > 0.0f && static_cast<float>(height) * scale_y < min_height_ratio * expected_height) continue;
+
+         detections.emplace_back( frame.Timestamp, pipeline.CameraIndex, foot_point );
+      }
+      pipeline.Segmentation.BusyTime += std::chrono::steady_clock::now() - start;
+      pipeline.Segmentation.FrameNum++;
+      if (!segmented.push( std::move( detections ) )) break;
+   }
+   segmented.close();
+}
+
+void VideoIngest::localize(
+   CameraPipeline& pipeline,
+   BoundedQueue<std::vector<Detection>>& segmented,
+   const LocalizedHandler& handler
+) const
+{
+   std::vector<Detection> detections;
+   std::vector<LocalizedDetection> localized;
+   while (segmented.pop( detections )) {
+      const auto start = std::chrono::steady_clock::now();
+      LocationDetector.detectLocations( localized, detections );
+      pipeline.Localization.BusyTime += std::chrono::steady_clock::now() - start;
+      pipeline.Localization.FrameNum++;
+      handler( localized );
+   }
+}
+
+bool VideoIngest::run(const LocalizedHandler& handler)
+{
+   if (Pipelines.empty()) return false;
+
+   const auto start = std::chrono::steady_clock::now();
+   std::vector<std::unique_ptr<BoundedQueue<Frame>>> decoded_queues;
+   std::vector<std::unique_ptr<BoundedQueue<std::vector<Detection>>>> segmented_queues;
+   std::vector<std::thread> threads;
+   for (auto& pipeline : Pipelines) {
+      decoded_queues.emplace_back( std::make_unique<BoundedQueue<Frame>>( QueueCapacity ) );
+      segmented_queues.emplace_back( std::make_unique<BoundedQueue<std::vector<Detection>>>( QueueCapacity ) );
+      threads.emplace_back( &VideoIngest::decode, std::ref( *pipeline ), std::ref( *decoded_queues.back() ) );
+      threads.emplace_back(
+         &VideoIngest::segment, this, std::ref( *pipeline ), std::ref( *decoded_queues.back() ), std::ref( *segmented_queues.back() )
+      );
+      threads.emplace_back(
+         &VideoIngest::localize, this, std::ref( *pipeline ), std::ref( *segmented_queues.back() ), std::cref( handler )
+      );
+   }
+   for (auto& thread : threads) thread.join();
+
+   const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+   for (const auto& pipeline : Pipelines) {
+      std::cerr << ">> Camera#" << pipeline->CameraIndex << " (" << pipeline->VideoPath << "): "
+         << pipeline->Localization.FrameNum << " frames, "
+         << (elapsed > 0.0 ? static_cast<double>(pipeline->Localization.FrameNum) / elapsed : 0.0) << " FPS overall / "
+         << "decoding " << pipeline->Decoding.getFPS() << " FPS, "
+         << "segmentation " << pipeline->Segmentation.getFPS() << " FPS, "
+         << "localization " << pipeline->Localization.getFPS() << " FPS\n";
+   }
+   return true;
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+/*
+ * Author: Emoy Kim
+ * E-mail: emoy.kim_AT_gmail.com
+ *
+ * This code is a free software; it can be freely used, changed and redistributed.
+ * If you use any version of the code, please reference the code.
+ *
+ */
+
+#pragma once
+
+#include <thread>
+#include <chrono>
+#include <functional>
+
+#include "LocationDetection.h"
+#include "BoundedQueue.h"
+
+// Produces localized detections from video files, one file per camera.
+// Each camera runs a pipeline of three threads connected by bounded queues:
+//  decoding frames -> background subtraction and blob extraction -> localization of the foot points.
+// Only the bounding box of the valid floor mask of the camera is segmented, and the foreground outside the spans of
+// the mask is cleared, so the rows of the sky or the walls are never processed. The foot point of a blob is its bottom center,
+// and a blob far shorter than a person expected at the foot point by the perspective scale map is dropped.
+// The frames per second of each stage are reported at the end, where a stage is timed only while it works.
+class VideoIngest
+{
+public:
+   using LocalizedHandler = std::function<void(const std::vector<LocalizedDetection>&)>;
+
+   explicit VideoIngest(const LocationDetection& location_detector, int min_blob_area = 150, size_t queue_capacity = 8);
+   ~VideoIngest() = default;
+
+   bool addCamera(int camera_index, const std::string& video_path);
+
+   // runs until all videos end. The handler is called with the detections of each frame from the localization
+   // thread of each camera, so it should be thread-safe.
+   bool run(const LocalizedHandler& handler);
+
+private:
+   struct Frame
+   {
+      double Timestamp;
+      cv::Mat Image;
+   };
+
+   struct StageStatistics
+   {
+      size_t FrameNum;
+      std::chrono::steady_clock::duration BusyTime;
+
+      StageStatistics() : FrameNum( 0 ), BusyTime( 0 ) {}
+      double getFPS() const;
+   };
+
+   struct CameraPipeline
+   {
+      int CameraIndex;
+      std::string VideoPath;
+      cv::VideoCapture Capture;
+      RunLengthMask FloorMask;
+      PerspectiveScaleMap ScaleMap;
+      StageStatistics Decoding;
+      StageStatistics Segmentation;
+      StageStatistics Localization;
+   };
+
+   const LocationDetection& LocationDetector;
+   int MinBlobArea;
+   size_t QueueCapacity;
+   std::vector<std::unique_ptr<CameraPipeline>> Pipelines;
+
+   static void decode(CameraPipeline& pipeline, BoundedQueue<Frame>& decoded);
+   void segment(CameraPipeline& pipeline, BoundedQueue<Frame>& decoded, BoundedQueue<std::vector<Detection>>& segmented) const;
+   void localize(CameraPipeline& pipeline, BoundedQueue<std::vector<Detection>>& segmented, const LocalizedHandler& handler) const;
+};
\ No newline at end of file
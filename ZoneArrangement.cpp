@@ -0,0 +1,129 @@
+#include "ZoneArrangement.h"
+
+void ZoneScene::addRing(const std::vector<cv::Point>& ring)
+{
+   if (ring.size() <= 2) return;
+
+   for (size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++) {
+      Vertices.emplace_back( ring[i] );
+      if (ring[i].y == ring[j].y) continue;
+
+      const cv::Point& lower = ring[i].y < ring[j].y ? ring[i] : ring[j];
+      const cv::Point& upper = ring[i].y < ring[j].y ? ring[j] : ring[i];
+      EdgeYMin.emplace_back( static_cast<float>(lower.y) );
+      EdgeYMax.emplace_back( static_cast<float>(upper.y) );
+      EdgeX.emplace_back( static_cast<float>(lower.x) );
+      EdgeInverseSlope.emplace_back( static_cast<float>(upper.x - lower.x) / static_cast<float>(upper.y - lower.y) );
+   }
+   RingOffsets.emplace_back( static_cast<int>(Vertices.size()) );
+}
+
+void ZoneScene::pack(const std::vector<CustomizedZone>& zones)
+{
+   Vertices.clear();
+   RingOffsets.assign( 1, 0 );
+   ZoneRingOffsets.assign( 1, 0 );
+   Altitudes.clear();
+   MinX.clear();
+   MinY.clear();
+   MaxX.clear();
+   MaxY.clear();
+   EdgeOffsets.assign( 1, 0 );
+   EdgeYMin.clear();
+   EdgeYMax.clear();
+   EdgeX.clear();
+   EdgeInverseSlope.clear();
+   for (const auto& zone : zones) {
+      float min_x = std::numeric_limits<float>::infinity(), min_y = std::numeric_limits<float>::infinity();
+      float max_x = -std::numeric_limits<float>::infinity(), max_y = -std::numeric_limits<float>::infinity();
+      if (zone.Zone.size() > 2) {
+         for (const auto& vertex : zone.Zone) {
+            min_x = std::min( min_x, static_cast<float>(vertex.x) );
+            min_y = std::min( min_y, static_cast<float>(vertex.y) );
+            max_x = std::max( max_x, static_cast<float>(vertex.x) );
+            max_y = std::max( max_y, static_cast<float>(vertex.y) );
+         }
+         addRing( zone.Zone );
+         for (const auto& hole : zone.Holes) addRing( hole );
+      }
+      Altitudes.emplace_back( zone.Altitude );
+      MinX.emplace_back( min_x );
+      MinY.emplace_back( min_y );
+      MaxX.emplace_back( max_x );
+      MaxY.emplace_back( max_y );
+      ZoneRingOffsets.emplace_back( static_cast<int>(RingOffsets.size()) - 1 );
+      EdgeOffsets.emplace_back( static_cast<int>(EdgeYMin.size()) );
+   }
+}
+
+bool ZoneScene::isInsideZone(const cv::Point2f& point, int zone_index) const
+{
+   if (point.x < MinX[zone_index] || point.y < MinY[zone_index] ||
+       point.x > MaxX[zone_index] || point.y > MaxY[zone_index]) return false;
+
+   bool is_inside = false;
+   const float* y_min = EdgeYMin.data();
+   const float* y_max = EdgeYMax.data();
+   const float* x = EdgeX.data();
+   const float* inverse_slope = EdgeInverseSlope.data();
+   for (int e = EdgeOffsets[zone_index]; e < EdgeOffsets[zone_index + 1]; ++e) {
+      if (y_min[e] <= point.y && point.y < y_max[e] && point.x < x[e] + (point.y - y_min[e]) * inverse_slope[e]) {
+         is_inside = !is_inside;
+      }
+   }
+   return is_inside;
+}
+
+void ZoneArrangement::paintZone(int zone_index)
+// fills the pixels for which the crossing test holds an odd number of times, one row at a time.
+{
+   if (Scene.EdgeOffsets[zone_index] == Scene.EdgeOffsets[zone_index + 1]) return;
+
+   const int min_y = std::max( static_cast<int>(Scene.MinY[zone_index]), 0 );
+   const int max_y = std::min( static_cast<int>(Scene.MaxY[zone_index]), RegionMap.rows - 1 );
+   std::vector<float> crossings;
+   for (int y = min_y; y <= max_y; ++y) {
+      const auto row = static_cast<float>(y);
+      crossings.clear();
+      for (int e = Scene.EdgeOffsets[zone_index]; e < Scene.EdgeOffsets[zone_index + 1]; ++e) {
+         if (Scene.EdgeYMin[e] <= row && row < Scene.EdgeYMax[e]) {
+            crossings.emplace_back( Scene.EdgeX[e] + (row - Scene.EdgeYMin[e]) * Scene.EdgeInverseSlope[e] );
+         }
+      }
+      std::sort( crossings.begin(), crossings.end() );
+
+      auto* region_ptr = RegionMap.ptr<int>(y);
+      for (size_t k = 0; k + 1 < crossings.size(); k += 2) {
+         const int from = std::max( static_cast<int>(std::ceil( crossings[k] )), 0 );
+         const int to = std::min( static_cast<int>(std::ceil( crossings[k + 1] )), RegionMap.cols );
+         for (int x = from; x < to; ++x) region_ptr[x] = zone_index + 1;
+      }
+   }
+}
+
+void ZoneArrangement::build(const std::vector<CustomizedZone>& zones, const cv::Size& floor_size, float default_altitude)
+{
+   Scene.pack( zones );
+   RegionMap = cv::Mat::zeros( floor_size, CV_32SC1 );
+   RegionAltitudes.resize( zones.size() + 1 );
+   RegionAltitudes[0] = default_altitude;
+   std::copy( Scene.Altitudes.begin(), Scene.Altitudes.end(), RegionAltitudes.begin() + 1 );
+
+   // paint the lower zones first so that the top zone remains in the overlapped area.
+   std::vector<int> painting_order(zones.size());
+   for (size_t i = 0; i < zones.size(); ++i) painting_order[i] = static_cast<int>(i);
+   std::sort(
+      painting_order.begin(), painting_order.end(),
+      [this](int a, int b)
+      {
+         const float altitude_a = Scene.Altitudes[a];
+         const float altitude_b = Scene.Altitudes[b];
+         return altitude_a != altitude_b ? altitude_a < altitude_b : a > b;
+      }
+   );
+   for (const auto& index : painting_order) paintZone( index );
+
+   AltitudeLevels = RegionAltitudes;
+   std::sort( AltitudeLevels.begin(), AltitudeLevels.end(), std::greater<>() );
+   AltitudeLevels.erase( std::unique( AltitudeLevels.begin(), AltitudeLevels.end() ), AltitudeLevels.end() );
+}
\ No newline at end of file
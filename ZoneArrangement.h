@@ -0,0 +1,94 @@
+/*
+ * Author: Emoy Kim
+ * E-mail: emoy.kim_AT_gmail.com
+ *
+ * This code is a free software; it can be freely used, changed and redistributed.
+ * If you use any version of the code, please reference the code.
+ *
+ */
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+// A zone can be concave and have holes. A point is inside a zone when the ray to the right of it crosses
+// the boundary of all rings an odd number of times.
+struct CustomizedZone
+{
+   float Altitude;
+   std::vector<cv::Point> Zone;
+   std::vector<std::vector<cv::Point>> Holes;
+
+   CustomizedZone() : Altitude( 0.0f ) {}
+   CustomizedZone(float altitude, std::vector<cv::Point> zone, std::vector<std::vector<cv::Point>> holes = {}) :
+      Altitude( altitude ), Zone( std::move( zone ) ), Holes( std::move( holes ) ) {}
+};
+
+// All zones packed in linear memory. The i-th zone owns the rings [ZoneRingOffsets[i], ZoneRingOffsets[i + 1]),
+// the k-th ring is Vertices[RingOffsets[k]] ~ Vertices[RingOffsets[k + 1] - 1], and the first ring is the outline.
+// The edges of the i-th zone are [EdgeOffsets[i], EdgeOffsets[i + 1]), and an edge crosses the horizontal line y
+// if EdgeYMin <= y < EdgeYMax, where the crossing is at EdgeX + (y - EdgeYMin) * EdgeInverseSlope.
+// Horizontal edges never cross, so they are not packed.
+struct ZoneScene
+{
+   std::vector<cv::Point> Vertices;
+   std::vector<int> RingOffsets;
+   std::vector<int> ZoneRingOffsets;
+   std::vector<float> Altitudes;
+   std::vector<float> MinX;
+   std::vector<float> MinY;
+   std::vector<float> MaxX;
+   std::vector<float> MaxY;
+   std::vector<int> EdgeOffsets;
+   std::vector<float> EdgeYMin;
+   std::vector<float> EdgeYMax;
+   std::vector<float> EdgeX;
+   std::vector<float> EdgeInverseSlope;
+
+   void pack(const std::vector<CustomizedZone>& zones);
+   int getZoneNum() const { return static_cast<int>(Altitudes.size()); }
+   bool isInsideZone(const cv::Point2f& point, int zone_index) const;
+   // a zone with less than 3 vertices has no edges, and its bounding box is empty with infinite bounds.
+   bool hasEdges(int zone_index) const { return EdgeOffsets[zone_index] < EdgeOffsets[zone_index + 1]; }
+
+private:
+   void addRing(const std::vector<cv::Point>& ring);
+};
+
+// Disjoint decomposition of the floor into regions which have only one effective altitude.
+// Region 0 is the floor which no zone covers, and region k is where the (k-1)-th zone is on top of the others.
+// When zones overlap, the zone of the higher altitude is on top, and the earlier zone wins the tie.
+class ZoneArrangement
+{
+public:
+   ZoneArrangement() = default;
+   ~ZoneArrangement() = default;
+
+   void build(const std::vector<CustomizedZone>& zones, const cv::Size& floor_size, float default_altitude);
+
+   int locate(const cv::Point& point) const
+   {
+      if (point.x < 0 || point.y < 0 || point.x >= RegionMap.cols || point.y >= RegionMap.rows) return -1;
+      return RegionMap.at<int>(point.y, point.x);
+   }
+   float getAltitude(int region) const { return RegionAltitudes[region]; }
+   bool isOnLevel(const cv::Point& point, float altitude) const
+   {
+      const int region = locate( point );
+      return region >= 0 && RegionAltitudes[region] == altitude;
+   }
+   const std::vector<float>& getAltitudeLevels() const { return AltitudeLevels; }
+   const ZoneScene& getScene() const { return Scene; }
+   bool isInsideZone(const cv::Point2f& point, int zone_index) const { return Scene.isInsideZone( point, zone_index ); }
+
+private:
+   cv::Mat RegionMap;
+   std::vector<float> RegionAltitudes;
+   std::vector<float> AltitudeLevels; // distinct altitudes of all regions in descending order
+   ZoneScene Scene;
+
+   void paintZone(int zone_index);
+};
\ No newline at end of file
@@ -0,0 +1,61 @@
+#include "ZoneOccupancy.h"
+
+ZoneOccupancy::ZoneOccupancy(const LocationDetection& location_detector, int shard_num) :
+   LocationDetector( location_detector ), ZoneNum( location_detector.getZoneNum() )
+{
+   for (int i = 0; i < shard_num; ++i) Shards.emplace_back( std::make_unique<Shard>( ZoneNum ) );
+}
+
+void ZoneOccupancy::publish(Shard& shard)
+// only the counts which changed are written, so a frame costs little when few targets move between zones.
+{
+   const uint64_t sequence = shard.Sequence.load( std::memory_order_relaxed );
+   shard.Sequence.store( sequence + 1, std::memory_order_relaxed );
+   std::atomic_thread_fence( std::memory_order_release );
+   for (int i = 0; i < ZoneNum; ++i) {
+      if (shard.Counts[i].load( std::memory_order_relaxed ) != shard.Histogram[i]) {
+         shard.Counts[i].store( shard.Histogram[i], std::memory_order_relaxed );
+      }
+   }
+   shard.Sequence.store( sequence + 2, std::memory_order_release );
+}
+
+void ZoneOccupancy::updateTracks(int shard, const std::vector<Track>& tracks)
+{
+   Shard& target = *Shards[shard];
+   std::fill( target.Histogram.begin(), target.Histogram.end(), 0 );
+   for (const auto& track : tracks) {
+      const int zone = LocationDetector.getZoneIndex( track.PositionInMeter );
+      if (0 <= zone && zone < ZoneNum) target.Histogram[zone]++;
+   }
+   publish( target );
+}
+
+void ZoneOccupancy::updateDetections(int shard, const std::vector<LocalizedDetection>& detections)
+{
+   Shard& target = *Shards[shard];
+   std::fill( target.Histogram.begin(), target.Histogram.end(), 0 );
+   for (const auto& localized : detections) {
+      if (localized.IsValid && 0 <= localized.ZoneIndex && localized.ZoneIndex < ZoneNum) {
+         target.Histogram[localized.ZoneIndex]++;
+      }
+   }
+   publish( target );
+}
+
+void ZoneOccupancy::getSnapshot(std::vector<int>& counts) const
+{
+   counts.assign( ZoneNum, 0 );
+   std::vector<int> shard_counts(ZoneNum);
+   for (const auto& shard : Shards) {
+      uint64_t before, after;
+      do {
+         before = shard->Sequence.load( std::memory_order_acquire );
+         for (int i = 0; i < ZoneNum; ++i) shard_counts[i] = shard->Counts[i].load( std::memory_order_relaxed );
+         std::atomic_thread_fence( std::memory_order_acquire );
+         after = shard->Sequence.load( std::memory_order_relaxed );
+      } while ((before & 1) != 0 || before != after);
+
+      for (int i = 0; i < ZoneNum; ++i) counts[i] += shard_counts[i];
+   }
+}
\ No newline at end of file
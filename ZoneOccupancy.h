@@ -0,0 +1,56 @@
+/*
+ * Author: Emoy Kim
+ * E-mail: emoy.kim_AT_gmail.com
+ *
+ * This code is a free software; it can be freely used, changed and redistributed.
+ * If you use any version of the code, please reference the code.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "LocationDetection.h"
+#include "MultiTargetTracker.h"
+
+// The number of targets in each zone now, which is counted from the latest frame of each shard.
+// A shard is owned by one writer thread, e.g. a tracker or an ingest thread of a set of cameras,
+// and each frame replaces the counts of its shard. A snapshot is the sum of all shards.
+// Writers never wait: a shard is published under a sequence lock, so only a reader which raced a writer retries,
+// and the counts of each shard in a snapshot are from the same frame.
+// The zones are those at construction, and the targets in zones added later are not counted.
+class ZoneOccupancy
+{
+public:
+   ZoneOccupancy(const LocationDetection& location_detector, int shard_num);
+   ~ZoneOccupancy() = default;
+
+   // called only by the writer thread of the shard.
+   void updateTracks(int shard, const std::vector<Track>& tracks);
+   void updateDetections(int shard, const std::vector<LocalizedDetection>& detections);
+
+   // counts[i] is the number of targets in the i-th zone, and the one outside all zones is not counted.
+   void getSnapshot(std::vector<int>& counts) const;
+   int getZoneNum() const { return ZoneNum; }
+
+private:
+   struct alignas(64) Shard
+   {
+      std::atomic<uint64_t> Sequence; // odd while the counts are being written
+      std::vector<std::atomic<int>> Counts;
+      std::vector<int> Histogram;     // scratch of the writer
+
+      explicit Shard(int zone_num) : Sequence( 0 ), Counts( zone_num ), Histogram( zone_num, 0 )
+      {
+         for (auto& count : Counts) count.store( 0, std::memory_order_relaxed );
+      }
+   };
+
+   const LocationDetection& LocationDetector;
+   int ZoneNum;
+   std::vector<std::unique_ptr<Shard>> Shards;
+
+   void publish(Shard& shard);
+};
\ No newline at end of file
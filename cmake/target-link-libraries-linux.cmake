@@ -1,7 +1,20 @@
+# video and videoio are not vendored in 3rd_party/opencv, so they are searched there first and then in the system.
+# set OPENCV_VIDEO_LIBRARY and OPENCV_VIDEOIO_LIBRARY to use others of the same version as the vendored ones.
+find_library(OPENCV_VIDEO_LIBRARY NAMES opencv_video HINTS "${CMAKE_SOURCE_DIR}/3rd_party/opencv/lib/linux")
+find_library(OPENCV_VIDEOIO_LIBRARY NAMES opencv_videoio HINTS "${CMAKE_SOURCE_DIR}/3rd_party/opencv/lib/linux")
+if(NOT OPENCV_VIDEO_LIBRARY OR NOT OPENCV_VIDEOIO_LIBRARY)
+   message(WARNING "opencv_video and opencv_videoio are not found, which the video ingest needs and 3rd_party/opencv does not have")
+   set(OPENCV_VIDEO_LIBRARY opencv_video${OPENCV_DEBUG_POSTFIX})
+   set(OPENCV_VIDEOIO_LIBRARY opencv_videoio${OPENCV_DEBUG_POSTFIX})
+endif()
+
 target_link_libraries(
      LocationDetectionFromCCTV
         opencv_core
         opencv_imgproc
         opencv_imgcodecs
         opencv_highgui
+        ${OPENCV_VIDEO_LIBRARY}
+        ${OPENCV_VIDEOIO_LIBRARY}
+        Threads::Threads
 )
\ No newline at end of file
@@ -1,5 +1,24 @@
+# video and videoio are not vendored in 3rd_party/opencv, so they are searched there first and then in OpenCV_DIR.
+# set OPENCV_VIDEO_LIBRARY and OPENCV_VIDEOIO_LIBRARY to use others of the same version as the vendored ones.
+if(${CMAKE_BUILD_TYPE} MATCHES Debug)
+   set(OPENCV_DEBUG_POSTFIX d)
+   find_library(OPENCV_VIDEO_LIBRARY NAMES opencv_videod HINTS "${CMAKE_SOURCE_DIR}/3rd_party/opencv/lib/windows/debug" "$ENV{OpenCV_DIR}/lib")
+   find_library(OPENCV_VIDEOIO_LIBRARY NAMES opencv_videoiod HINTS "${CMAKE_SOURCE_DIR}/3rd_party/opencv/lib/windows/debug" "$ENV{OpenCV_DIR}/lib")
+else()
+   find_library(OPENCV_VIDEO_LIBRARY NAMES opencv_video HINTS "${CMAKE_SOURCE_DIR}/3rd_party/opencv/lib/windows/release" "$ENV{OpenCV_DIR}/lib")
+   find_library(OPENCV_VIDEOIO_LIBRARY NAMES opencv_videoio HINTS "${CMAKE_SOURCE_DIR}/3rd_party/opencv/lib/windows/release" "$ENV{OpenCV_DIR}/lib")
+endif()
+if(NOT OPENCV_VIDEO_LIBRARY OR NOT OPENCV_VIDEOIO_LIBRARY)
+   message(WARNING "opencv_video and opencv_videoio are not found, which the video ingest needs and 3rd_party/opencv does not have")
+   set(OPENCV_VIDEO_LIBRARY opencv_video${OPENCV_DEBUG_POSTFIX})
+   set(OPENCV_VIDEOIO_LIBRARY opencv_videoio${OPENCV_DEBUG_POSTFIX})
+endif()
+
 if(${CMAKE_BUILD_TYPE} MATCHES Debug)
    target_link_libraries(LocationDetectionFromCCTV opencv_cored opencv_imgprocd opencv_imgcodecsd opencv_highguid)
 else()
    target_link_libraries(LocationDetectionFromCCTV opencv_core opencv_imgproc opencv_imgcodecs opencv_highgui)
-endif()
\ No newline at end of file
+endif()
+target_link_libraries(LocationDetectionFromCCTV ${OPENCV_VIDEO_LIBRARY} ${OPENCV_VIDEOIO_LIBRARY})
+
+target_link_libraries(LocationDetectionFromCCTV Threads::Threads)
\ No newline at end of file
@@ -1,4 +1,14 @@
 #include "LocationDetection.h"
+#include "DetectionStream.h"
+#include "BulkConverter.h"
+#include "ReplayDriver.h"
+#include "SpatioTemporalIndex.h"
+#include "TrajectoryStore.h"
+#include "VideoIngest.h"
+#include "SparseAssignment.h"
+#include "DwellStatistics.h"
+
+#include <stdexcept>
 
 void setCCTV1(LocationDetection& location_detector)
 {
@@ -96,16 +106,153 @@ void testReprojection(LocationDetection& location_detector)
    std::cout << "The projected point " << camera_point << " is reprojected on " << reprojected << "(in meter)\n";
 }
 
-int main()
+void setCCTVs(LocationDetection& location_detector)
 {
-   const float floor_width_in_meter = 160.0f;
-   const float floor_height_in_meter = 93.0f;
-   LocationDetection location_detector(floor_width_in_meter, floor_height_in_meter);
-
    setCCTV1( location_detector );
    setCCTV2( location_detector );
    setCCTV3( location_detector );
    setCCTV4( location_detector );
+}
+
+bool buildSpatioTemporalIndex(const std::string& log_path, const std::string& index_path)
+{
+   EventLogReader reader;
+   if (!reader.open( log_path )) {
+      std::cerr << "Cannot Open the Event Log: " << log_path << "\n";
+      return false;
+   }
+   SpatioTemporalIndexWriter writer;
+   if (!writer.open( index_path )) {
+      std::cerr << "Cannot Open the Index: " << index_path << "\n";
+      return false;
+   }
+   for (size_t c = 0; c < reader.getChunkNum(); ++c) {
+      const EventChunk chunk = reader.getChunk( c );
+      for (size_t i = 0; i < chunk.Size; ++i) writer.write( chunk.getLocalizedDetection( i ) );
+   }
+   return writer.close();
+}
+
+bool querySpatioTemporalIndex(const std::string& index_path, const cv::Rect2f& area_in_meter, double begin_time, double end_time)
+{
+   SpatioTemporalIndexReader reader;
+   if (!reader.open( index_path )) {
+      std::cerr << "Cannot Open the Index: " << index_path << "\n";
+      return false;
+   }
+   std::vector<PositionRecord> results;
+   reader.query( results, area_in_meter, begin_time, end_time );
+   for (const auto& record : results) {
+      std::cout << record.Timestamp << "," << record.Id << "," << record.PositionInMeter.x << "," << record.PositionInMeter.y << "\n";
+   }
+   std::cerr << results.size() << " records from " << reader.getReadBlockNum() << " blocks\n";
+   return true;
+}
+
+bool ingestVideos(const std::vector<std::string>& video_paths, const LocationDetection& location_detector)
+// the i-th video is of the i-th camera set, and the valid locations are written to stdout.
+{
+   VideoIngest ingest(location_detector);
+   for (size_t i = 0; i < video_paths.size(); ++i) {
+      if (!ingest.addCamera( static_cast<int>(i), video_paths[i] )) return false;
+   }
+
+   std::mutex output_mutex;
+   return ingest.run(
+      [&output_mutex](const std::vector<LocalizedDetection>& localized)
+      {
+         char buffer[LocalizedDetectionLineMaxLength];
+         std::lock_guard<std::mutex> lock( output_mutex );
+         for (const auto& detection : localized) {
+            if (detection.IsValid) std::cout.write( buffer, static_cast<std::streamsize>(formatLocalizedDetection( buffer, detection )) );
+         }
+      }
+   );
+}
+
+void printHeadlessUsage()
+{
+   std::cerr << "Usage:\n"
+      "   LocationDetectionFromCCTV --stream [input path or -] [output path or -]\n"
+      "   LocationDetectionFromCCTV --convert <input path> <output path> [thread number]\n"
+      "   LocationDetectionFromCCTV --replay <event log path> [speed multiplier, 0 for full speed] [output event log path]\n"
+      "   LocationDetectionFromCCTV --index <event log path> <index path>\n"
+      "   LocationDetectionFromCCTV --query <index path> <x(m)> <y(m)> <width(m)> <height(m)> <begin time> <end time>\n"
+      "   LocationDetectionFromCCTV --trajectory-bench <trajectory store path> [track number] [duration in seconds]\n"
+      "   LocationDetectionFromCCTV --video <video path of camera 0> [video path of camera 1] ...\n"
+      "   LocationDetectionFromCCTV --assignment-check [instance number] [size up to 10]\n"
+      "   LocationDetectionFromCCTV --tdigest-check [sample number]\n";
+}
+
+int runHeadless(int argc, char** argv, LocationDetection& location_detector)
+// the numbers in the arguments are parsed by std::sto*(), which throw on a typo and are caught in main().
+{
+   const std::string mode(argv[1]);
+   const auto argument = [argc, argv](int i, const char* default_value)
+   {
+      return std::string(i < argc ? argv[i] : default_value);
+   };
+
+   if (mode == "--stream") {
+      std::ios::sync_with_stdio( false );
+      DetectionStream stream(location_detector);
+      return stream.run( argument( 2, "-" ), argument( 3, "-" ) ) ? 0 : 1;
+   }
+   if (mode == "--convert" && argc >= 4) {
+      BulkConverter converter(location_detector, std::stoi( argument( 4, "0" ) ));
+      return converter.convert( argv[2], argv[3] ) ? 0 : 1;
+   }
+   if (mode == "--replay" && argc >= 3) {
+      ReplayDriver driver(location_detector);
+      return driver.replay( argv[2], std::stod( argument( 3, "1" ) ), argument( 4, "" ) ) ? 0 : 1;
+   }
+   if (mode == "--index" && argc >= 4) {
+      return buildSpatioTemporalIndex( argv[2], argv[3] ) ? 0 : 1;
+   }
+   if (mode == "--query" && argc >= 9) {
+      const cv::Rect2f area(std::stof( argv[3] ), std::stof( argv[4] ), std::stof( argv[5] ), std::stof( argv[6] ));
+      return querySpatioTemporalIndex( argv[2], area, std::stod( argv[7] ), std::stod( argv[8] ) ) ? 0 : 1;
+   }
+   if (mode == "--trajectory-bench" && argc >= 3) {
+      const double resolution_in_meter = 1.0 / location_detector.getMeterToPixel();
+      return benchmarkTrajectoryStore(
+         argv[2], resolution_in_meter, std::stoi( argument( 3, "1000" ) ), std::stod( argument( 4, "60" ) )
+      ) ? 0 : 1;
+   }
+   if (mode == "--assignment-check") {
+      return checkSparseAssignment( std::stoi( argument( 2, "1000" ) ), std::stoi( argument( 3, "6" ) ) ) ? 0 : 1;
+   }
+   if (mode == "--tdigest-check") {
+      return checkTDigest( std::stoi( argument( 2, "200000" ) ) ) ? 0 : 1;
+   }
+   if (mode == "--video" && argc >= 3) {
+      return ingestVideos( std::vector<std::string>(argv + 2, argv + argc), location_detector ) ? 0 : 1;
+   }
+   std::cerr << "Unknown Mode: " << mode << "\n";
+   printHeadlessUsage();
+   return 1;
+}
+
+int main(int argc, char** argv)
+{
+   const float floor_width_in_meter = 160.0f;
+   const float floor_height_in_meter = 93.0f;
+   if (argc > 1) {
+      LocationDetection location_detector(floor_width_in_meter, floor_height_in_meter, {}, 0.0f, false);
+      setCCTVs( location_detector );
+      try {
+         return runHeadless( argc, argv, location_detector );
+      }
+      catch (const std::logic_error& error) { // std::invalid_argument or std::out_of_range
+         std::cerr << "Invalid Argument: " << error.what() << "\n";
+         printHeadlessUsage();
+         return 1;
+      }
+   }
+
+   LocationDetection location_detector(floor_width_in_meter, floor_height_in_meter);
+
+   setCCTVs( location_detector );
 
    location_detector.generateEventOnWorldMap();
 